@@ -0,0 +1,76 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "CMakeFiles/VerifyGlobs.cmake"
+  "CMakeFiles/cmake.verify_globs"
+  "/root/repo/benchmarks/CMakeLists.txt"
+  "/root/repo/tests/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFileCXX.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "benchmarks/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "tests/CMakeFiles/runUnitTests.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/append_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/bubble_map_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/combining_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/comparisons_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/concurrent_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/convert_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/hinted_insert_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/mvcc_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/node_handle_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/priority_queue_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/range_aggregate_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/range_erase_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/range_scan_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/read_latency_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/set_algebra_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/sharded_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/skiplist_bucket_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/snapshot_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/split_concat_benchmark.dir/DependInfo.cmake"
+  "benchmarks/CMakeFiles/top_n_benchmark.dir/DependInfo.cmake"
+  )
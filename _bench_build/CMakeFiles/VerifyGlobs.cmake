@@ -0,0 +1,63 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by CMake Version 3.25
+cmake_policy(SET CMP0009 NEW)
+
+# BENCHMARK_SOURCES at benchmarks/CMakeLists.txt:3 (file)
+file(GLOB NEW_GLOB LIST_DIRECTORIES true "/root/repo/benchmarks/*.cc")
+set(OLD_GLOB
+  "/root/repo/benchmarks/append.cc"
+  "/root/repo/benchmarks/bubble_map.cc"
+  "/root/repo/benchmarks/combining.cc"
+  "/root/repo/benchmarks/comparisons.cc"
+  "/root/repo/benchmarks/concurrent.cc"
+  "/root/repo/benchmarks/convert.cc"
+  "/root/repo/benchmarks/hinted_insert.cc"
+  "/root/repo/benchmarks/mvcc.cc"
+  "/root/repo/benchmarks/node_handle.cc"
+  "/root/repo/benchmarks/priority_queue.cc"
+  "/root/repo/benchmarks/range_aggregate.cc"
+  "/root/repo/benchmarks/range_erase.cc"
+  "/root/repo/benchmarks/range_scan.cc"
+  "/root/repo/benchmarks/read_latency.cc"
+  "/root/repo/benchmarks/set_algebra.cc"
+  "/root/repo/benchmarks/sharded.cc"
+  "/root/repo/benchmarks/skiplist_bucket.cc"
+  "/root/repo/benchmarks/snapshot.cc"
+  "/root/repo/benchmarks/split_concat.cc"
+  "/root/repo/benchmarks/top_n.cc"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bench_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# TEST_SOURCES at tests/CMakeLists.txt:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/tests/*.cc")
+set(OLD_GLOB
+  "/root/repo/tests/avl.cc"
+  "/root/repo/tests/bubble.cc"
+  "/root/repo/tests/bubble_map.cc"
+  "/root/repo/tests/bubble_multiset.cc"
+  "/root/repo/tests/bubble_mvcc.cc"
+  "/root/repo/tests/bubble_top_n.cc"
+  "/root/repo/tests/concurrent_bubble.cc"
+  "/root/repo/tests/epoch.cc"
+  "/root/repo/tests/lockfree_skiplist.cc"
+  "/root/repo/tests/sharded_bubble.cc"
+  "/root/repo/tests/spsc_queue.cc"
+  "/root/repo/tests/test_main.cc"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bench_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# TEST_SOURCES at tests/CMakeLists.txt:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/tests/test_main.cc")
+set(OLD_GLOB
+  "/root/repo/tests/test_main.cc"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bench_build/CMakeFiles/cmake.verify_globs")
+endif()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/append_benchmark.dir/append.cc.o"
+  "CMakeFiles/append_benchmark.dir/append.cc.o.d"
+  "append_benchmark"
+  "append_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/append_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bubble_map_benchmark.dir/bubble_map.cc.o"
+  "CMakeFiles/bubble_map_benchmark.dir/bubble_map.cc.o.d"
+  "bubble_map_benchmark"
+  "bubble_map_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bubble_map_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
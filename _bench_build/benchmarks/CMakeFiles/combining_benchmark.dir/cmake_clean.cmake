@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/combining_benchmark.dir/combining.cc.o"
+  "CMakeFiles/combining_benchmark.dir/combining.cc.o.d"
+  "combining_benchmark"
+  "combining_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/combining_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
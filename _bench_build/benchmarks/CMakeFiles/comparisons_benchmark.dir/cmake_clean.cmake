@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/comparisons_benchmark.dir/comparisons.cc.o"
+  "CMakeFiles/comparisons_benchmark.dir/comparisons.cc.o.d"
+  "comparisons_benchmark"
+  "comparisons_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/comparisons_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
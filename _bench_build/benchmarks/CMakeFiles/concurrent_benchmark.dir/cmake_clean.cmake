@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/concurrent_benchmark.dir/concurrent.cc.o"
+  "CMakeFiles/concurrent_benchmark.dir/concurrent.cc.o.d"
+  "concurrent_benchmark"
+  "concurrent_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/concurrent_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
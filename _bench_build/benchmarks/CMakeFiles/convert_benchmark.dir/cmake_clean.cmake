@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/convert_benchmark.dir/convert.cc.o"
+  "CMakeFiles/convert_benchmark.dir/convert.cc.o.d"
+  "convert_benchmark"
+  "convert_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/convert_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hinted_insert_benchmark.dir/hinted_insert.cc.o"
+  "CMakeFiles/hinted_insert_benchmark.dir/hinted_insert.cc.o.d"
+  "hinted_insert_benchmark"
+  "hinted_insert_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/hinted_insert_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
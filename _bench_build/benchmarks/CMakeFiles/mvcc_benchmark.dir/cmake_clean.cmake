@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/mvcc_benchmark.dir/mvcc.cc.o"
+  "CMakeFiles/mvcc_benchmark.dir/mvcc.cc.o.d"
+  "mvcc_benchmark"
+  "mvcc_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/mvcc_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
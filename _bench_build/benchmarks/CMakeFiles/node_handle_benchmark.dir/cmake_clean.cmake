@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/node_handle_benchmark.dir/node_handle.cc.o"
+  "CMakeFiles/node_handle_benchmark.dir/node_handle.cc.o.d"
+  "node_handle_benchmark"
+  "node_handle_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/node_handle_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
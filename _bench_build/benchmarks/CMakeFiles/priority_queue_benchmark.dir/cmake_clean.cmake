@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/priority_queue_benchmark.dir/priority_queue.cc.o"
+  "CMakeFiles/priority_queue_benchmark.dir/priority_queue.cc.o.d"
+  "priority_queue_benchmark"
+  "priority_queue_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/priority_queue_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
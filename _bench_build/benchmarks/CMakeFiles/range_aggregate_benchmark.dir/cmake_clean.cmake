@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/range_aggregate_benchmark.dir/range_aggregate.cc.o"
+  "CMakeFiles/range_aggregate_benchmark.dir/range_aggregate.cc.o.d"
+  "range_aggregate_benchmark"
+  "range_aggregate_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/range_aggregate_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
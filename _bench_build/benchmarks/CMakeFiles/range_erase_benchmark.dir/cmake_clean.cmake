@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/range_erase_benchmark.dir/range_erase.cc.o"
+  "CMakeFiles/range_erase_benchmark.dir/range_erase.cc.o.d"
+  "range_erase_benchmark"
+  "range_erase_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/range_erase_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
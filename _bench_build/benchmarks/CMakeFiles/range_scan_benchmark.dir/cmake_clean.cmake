@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/range_scan_benchmark.dir/range_scan.cc.o"
+  "CMakeFiles/range_scan_benchmark.dir/range_scan.cc.o.d"
+  "range_scan_benchmark"
+  "range_scan_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/range_scan_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/read_latency_benchmark.dir/read_latency.cc.o"
+  "CMakeFiles/read_latency_benchmark.dir/read_latency.cc.o.d"
+  "read_latency_benchmark"
+  "read_latency_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/read_latency_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/set_algebra_benchmark.dir/set_algebra.cc.o"
+  "CMakeFiles/set_algebra_benchmark.dir/set_algebra.cc.o.d"
+  "set_algebra_benchmark"
+  "set_algebra_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/set_algebra_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
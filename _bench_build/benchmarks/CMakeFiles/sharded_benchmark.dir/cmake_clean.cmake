@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sharded_benchmark.dir/sharded.cc.o"
+  "CMakeFiles/sharded_benchmark.dir/sharded.cc.o.d"
+  "sharded_benchmark"
+  "sharded_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sharded_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/skiplist_bucket_benchmark.dir/skiplist_bucket.cc.o"
+  "CMakeFiles/skiplist_bucket_benchmark.dir/skiplist_bucket.cc.o.d"
+  "skiplist_bucket_benchmark"
+  "skiplist_bucket_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/skiplist_bucket_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
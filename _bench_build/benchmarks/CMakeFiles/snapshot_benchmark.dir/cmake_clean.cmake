@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/snapshot_benchmark.dir/snapshot.cc.o"
+  "CMakeFiles/snapshot_benchmark.dir/snapshot.cc.o.d"
+  "snapshot_benchmark"
+  "snapshot_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/snapshot_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
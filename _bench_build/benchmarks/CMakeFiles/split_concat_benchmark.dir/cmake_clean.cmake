@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/split_concat_benchmark.dir/split_concat.cc.o"
+  "CMakeFiles/split_concat_benchmark.dir/split_concat.cc.o.d"
+  "split_concat_benchmark"
+  "split_concat_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/split_concat_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
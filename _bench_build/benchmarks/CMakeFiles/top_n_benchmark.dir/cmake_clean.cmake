@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/top_n_benchmark.dir/top_n.cc.o"
+  "CMakeFiles/top_n_benchmark.dir/top_n.cc.o.d"
+  "top_n_benchmark"
+  "top_n_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/top_n_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
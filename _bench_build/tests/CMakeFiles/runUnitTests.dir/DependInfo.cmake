@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/avl.cc" "tests/CMakeFiles/runUnitTests.dir/avl.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/avl.cc.o.d"
+  "/root/repo/tests/bubble.cc" "tests/CMakeFiles/runUnitTests.dir/bubble.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/bubble.cc.o.d"
+  "/root/repo/tests/bubble_map.cc" "tests/CMakeFiles/runUnitTests.dir/bubble_map.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/bubble_map.cc.o.d"
+  "/root/repo/tests/bubble_multiset.cc" "tests/CMakeFiles/runUnitTests.dir/bubble_multiset.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/bubble_multiset.cc.o.d"
+  "/root/repo/tests/bubble_mvcc.cc" "tests/CMakeFiles/runUnitTests.dir/bubble_mvcc.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/bubble_mvcc.cc.o.d"
+  "/root/repo/tests/bubble_top_n.cc" "tests/CMakeFiles/runUnitTests.dir/bubble_top_n.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/bubble_top_n.cc.o.d"
+  "/root/repo/tests/concurrent_bubble.cc" "tests/CMakeFiles/runUnitTests.dir/concurrent_bubble.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/concurrent_bubble.cc.o.d"
+  "/root/repo/tests/epoch.cc" "tests/CMakeFiles/runUnitTests.dir/epoch.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/epoch.cc.o.d"
+  "/root/repo/tests/lockfree_skiplist.cc" "tests/CMakeFiles/runUnitTests.dir/lockfree_skiplist.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/lockfree_skiplist.cc.o.d"
+  "/root/repo/tests/sharded_bubble.cc" "tests/CMakeFiles/runUnitTests.dir/sharded_bubble.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/sharded_bubble.cc.o.d"
+  "/root/repo/tests/spsc_queue.cc" "tests/CMakeFiles/runUnitTests.dir/spsc_queue.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/spsc_queue.cc.o.d"
+  "/root/repo/tests/test_main.cc" "tests/CMakeFiles/runUnitTests.dir/test_main.cc.o" "gcc" "tests/CMakeFiles/runUnitTests.dir/test_main.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,33 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/runUnitTests.dir/avl.cc.o"
+  "CMakeFiles/runUnitTests.dir/avl.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/bubble.cc.o"
+  "CMakeFiles/runUnitTests.dir/bubble.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/bubble_map.cc.o"
+  "CMakeFiles/runUnitTests.dir/bubble_map.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/bubble_multiset.cc.o"
+  "CMakeFiles/runUnitTests.dir/bubble_multiset.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/bubble_mvcc.cc.o"
+  "CMakeFiles/runUnitTests.dir/bubble_mvcc.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/bubble_top_n.cc.o"
+  "CMakeFiles/runUnitTests.dir/bubble_top_n.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/concurrent_bubble.cc.o"
+  "CMakeFiles/runUnitTests.dir/concurrent_bubble.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/epoch.cc.o"
+  "CMakeFiles/runUnitTests.dir/epoch.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/lockfree_skiplist.cc.o"
+  "CMakeFiles/runUnitTests.dir/lockfree_skiplist.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/sharded_bubble.cc.o"
+  "CMakeFiles/runUnitTests.dir/sharded_bubble.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/spsc_queue.cc.o"
+  "CMakeFiles/runUnitTests.dir/spsc_queue.cc.o.d"
+  "CMakeFiles/runUnitTests.dir/test_main.cc.o"
+  "CMakeFiles/runUnitTests.dir/test_main.cc.o.d"
+  "runUnitTests"
+  "runUnitTests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/runUnitTests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
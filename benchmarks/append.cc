@@ -0,0 +1,44 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <set>
+#include <vector>
+
+int main() {
+    const size_t n = 5000000;
+    // an event log index: every id is bigger than the previous one, with gaps
+    std::vector<uint64_t> ids(n);
+    for(size_t i = 0; i < n; i++) {
+        ids[i] = 1000 + i * 3 + (i % 7);
+    }
+    size_t found = 0;
+
+    {
+        bubble<uint64_t, 1024> b;
+        report("bubble<u64, 1024> insert", measure([&]() {
+            for(auto && id : ids) { b.insert(id); }
+        }), n);
+        report("bubble<u64, 1024> find after insert", measure([&]() {
+            for(auto && id : ids) { found += b.search(id); }
+        }), n);
+    }
+
+    {
+        bubble<uint64_t, 1024> b;
+        report("bubble<u64, 1024> append", measure([&]() {
+            for(auto && id : ids) { b.append(id); }
+        }), n);
+        report("bubble<u64, 1024> find after append", measure([&]() {
+            for(auto && id : ids) { found += b.search(id); }
+        }), n);
+    }
+
+    {
+        std::set<uint64_t> s;
+        report("std::set<u64> insert at end()", measure([&]() {
+            for(auto && id : ids) { s.insert(s.end(), id); }
+        }), n);
+    }
+
+    do_not_optimize(found);
+    return 0;
+}
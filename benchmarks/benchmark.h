@@ -0,0 +1,49 @@
+/**
+* @brief Small timing helpers shared by the benchmarks. Every benchmark is a standalone
+* executable, build them with cmake -DENABLE_BENCHMARKS=ON and run them from the build folder
+*/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#ifdef __cplusplus
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#endif
+
+/**
+* @brief measure function
+* @param f: the workload to run once
+* @return double: the elapsed wall clock time in milliseconds
+*/
+template <typename F>
+double measure(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/**
+* @brief report function, prints one aligned result row
+* @param name: the name of the measured configuration
+* @param ms: the elapsed time in milliseconds
+* @param ops: the number of operations that ran in that time
+*/
+inline void report(const std::string& name, double ms, size_t ops) {
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(12) << std::fixed << std::setprecision(2) << ms << " ms"
+              << std::setw(14) << std::setprecision(2) << (ops / ms / 1000.0) << " Mops/s" << '\n';
+}
+
+/**
+* @brief do_not_optimize function, keeps the compiler from dropping a result
+*/
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif
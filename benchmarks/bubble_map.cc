@@ -0,0 +1,62 @@
+#include "../src/bubble_map.h"
+#include "benchmark.h"
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/**
+* @brief a payload that is big enough to hurt cache density when it sits next to the keys
+*/
+struct payload {
+    uint64_t fields[8];
+};
+
+int main() {
+    const size_t n = 1000000;
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> keys(n);
+    for(auto && key : keys) {
+        key = rng();
+    }
+    std::vector<uint64_t> lookups(keys);
+    std::shuffle(lookups.begin(), lookups.end(), rng);
+    uint64_t sum = 0;
+
+    {
+        bubble_map<uint64_t, payload, 1024> m;
+        report("bubble_map<u64, payload, 1024> insert", measure([&]() {
+            for(auto && key : keys) { m.try_emplace(key, payload{{key}}); }
+        }), n);
+        report("bubble_map<u64, payload, 1024> find", measure([&]() {
+            for(auto && key : lookups) { sum += m.find(key)->fields[0]; }
+        }), n);
+    }
+
+    {
+        std::map<uint64_t, payload> m;
+        report("std::map<u64, payload> insert", measure([&]() {
+            for(auto && key : keys) { m.try_emplace(key, payload{{key}}); }
+        }), n);
+        report("std::map<u64, payload> find", measure([&]() {
+            for(auto && key : lookups) { sum += m.find(key)->second.fields[0]; }
+        }), n);
+    }
+
+    {
+        bubble<uint64_t, 1024> b;
+        std::unordered_map<uint64_t, payload> m;
+        report("bubble<u64, 1024> + unordered_map insert", measure([&]() {
+            for(auto && key : keys) {
+                b.insert(key);
+                m.try_emplace(key, payload{{key}});
+            }
+        }), n);
+        report("bubble<u64, 1024> + unordered_map find", measure([&]() {
+            for(auto && key : lookups) {
+                if(b.search(key)) { sum += m.find(key)->second.fields[0]; }
+            }
+        }), n);
+    }
+    do_not_optimize(sum);
+}
@@ -0,0 +1,54 @@
+#include "../src/concurrent_bubble.h"
+#include "benchmark.h"
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000, ops = 128000;
+    std::mt19937_64 rng(43);
+    bubble<uint64_t, 1024> seed;
+    for(size_t i = 0; i < n; i++) { seed.insert(rng()); }
+    // skewed writes, hot_percent of them go between two neighbouring pivots
+    uint64_t low = seed.get_key(512), width = seed.get_key(513) - low;
+    auto writes = [&](size_t hot_percent) {
+        std::vector<uint64_t> keys(ops);
+        for(auto && key : keys) { key = rng() % 100 < hot_percent ? low + 1 + rng() % (width - 1) : rng(); }
+        return keys;
+    };
+    uint64_t sum = 0;
+
+    // every thread inserts its share of the keys and removes it again, so the size stays put
+    auto run = [&](auto& b, const std::vector<uint64_t>& keys, size_t threads) {
+        std::vector<std::thread> workers;
+        std::vector<size_t> changed(threads);
+        for(size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                for(size_t i = t; i < ops; i += threads) {
+                    changed[t] += b.insert(keys[i]);
+                    changed[t] += b.remove(keys[i]);
+                }
+            });
+        }
+        for(auto && worker : workers) { worker.join(); }
+        for(size_t c : changed) { sum += c; }
+    };
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    concurrent_bubble<uint64_t, 1024> locked(seed);
+    concurrent_bubble<uint64_t, 1024, std::less<>, std::identity{}, combining_avl_bucket> combining(seed);
+    concurrent_bubble<uint64_t, 1024, std::less<>, std::identity{}, lockfree_skiplist> skiplist(seed);
+    for(size_t hot_percent : {50, 90, 100}) {
+        std::vector<uint64_t> keys = writes(hot_percent);
+        for(size_t threads : {1, 4, 16, 64}) {
+            std::string suffix = ", " + std::to_string(hot_percent) + "% hot x" + std::to_string(threads);
+            report("cow_avl_bucket" + suffix, measure([&]() { run(locked, keys, threads); }), 2 * ops);
+            report("combining_avl_bucket" + suffix, measure([&]() { run(combining, keys, threads); }), 2 * ops);
+            report("lockfree_skiplist" + suffix, measure([&]() { run(skiplist, keys, threads); }), 2 * ops);
+        }
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+* @brief URL-like key that counts every full comparison, all keys share a long prefix so each
+* comparison has to walk over it before it finds a difference
+*/
+struct counted_url {
+    std::string url;
+    static inline size_t comparisons = 0;
+
+    friend bool operator<(const counted_url& a, const counted_url& b) {
+        comparisons++;
+        return a.url < b.url;
+    }
+
+    friend bool operator==(const counted_url& a, const counted_url& b) {
+        comparisons++;
+        return a.url == b.url;
+    }
+
+    friend std::strong_ordering operator<=>(const counted_url& a, const counted_url& b) {
+        comparisons++;
+        return a.url.compare(b.url) <=> 0;
+    }
+};
+
+/**
+* @brief strict weak ordering that only exposes operator<, this is what every hot path had to
+* work with before the three-way comparison policy
+*/
+struct two_way_less {
+    bool operator()(const counted_url& a, const counted_url& b) const { return a < b; }
+};
+
+template <typename Compare>
+void run(const std::string& name, const std::vector<counted_url>& keys, const std::vector<counted_url>& lookups) {
+    bubble<counted_url, 1024, Compare> b;
+    for(auto && key : keys) {
+        b.insert(key);
+    }
+    counted_url::comparisons = 0;
+    size_t found = 0;
+    double ms = measure([&]() {
+        for(auto && key : lookups) {
+            found += b.search(key);
+        }
+    });
+    do_not_optimize(found);
+    report(name, ms, lookups.size());
+    std::cout << "    comparisons per lookup: " << std::setprecision(2)
+              << static_cast<double>(counted_url::comparisons) / lookups.size() << '\n';
+}
+
+int main() {
+    const size_t n = 200000;
+    std::mt19937_64 rng(42);
+    std::vector<counted_url> keys;
+    keys.reserve(n);
+    for(size_t i = 0; i<n; i++){
+        keys.push_back({"https://api.example.com/v1/tenants/acme/users/" + std::to_string(rng() % 1000000000) + "/profile"});
+    }
+    std::vector<counted_url> lookups(keys);
+    std::shuffle(lookups.begin(), lookups.end(), rng);
+    for(size_t i = 0; i<n / 2; i++){
+        lookups[i].url += "?missing";
+    }
+
+    run<two_way_less>("bubble<url, 1024> two-way comparator", keys, lookups);
+    run<std::less<>>("bubble<url, 1024> three-way (std::less<>)", keys, lookups);
+    run<std::compare_three_way>("bubble<url, 1024> std::compare_three_way", keys, lookups);
+}
@@ -0,0 +1,84 @@
+#include "../src/concurrent_bubble.h"
+#include "benchmark.h"
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+* @brief a plain bubble behind one lock, Mutex is std::mutex or std::shared_mutex
+*/
+template <typename Mutex>
+struct locked_bubble {
+    bubble<uint64_t, 1024> keys;
+    mutable Mutex lock;
+
+    bool insert(uint64_t key) {
+        std::unique_lock<Mutex> guard(lock);
+        return keys.insert(key).second;
+    }
+    size_t remove(uint64_t key) {
+        std::unique_lock<Mutex> guard(lock);
+        return keys.remove(key);
+    }
+    bool search(uint64_t key) const {
+        if constexpr (std::is_same_v<Mutex, std::shared_mutex>) {
+            std::shared_lock<Mutex> guard(lock);
+            return keys.search(key);
+        }
+        else {
+            std::unique_lock<Mutex> guard(lock);
+            return keys.search(key);
+        }
+    }
+};
+
+int main() {
+    const size_t n = 1000000, ops = 256000;
+    std::mt19937_64 rng(37);
+    bubble<uint64_t, 1024> seed;
+    std::vector<uint64_t> present(n), fresh(ops);
+    for(auto && key : present) { key = rng(); seed.insert(key); }
+    for(auto && key : fresh) { key = rng(); }
+    uint64_t sum = 0;
+
+    // every thread runs ops / threads operations, a write inserts a fresh key and removes it again
+    // so the size stays put, a read searches a key that exists
+    auto run = [&](auto& b, size_t threads, size_t write_percent) {
+        std::vector<std::thread> workers;
+        std::vector<size_t> found(threads);
+        for(size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                for(size_t i = t; i < ops; i += threads) {
+                    if(i * 7 % 100 < write_percent) {
+                        b.insert(fresh[i]);
+                        b.remove(fresh[i]);
+                    }
+                    else {
+                        found[t] += b.search(present[i * 13 % n]);
+                    }
+                }
+            });
+        }
+        for(auto && worker : workers) { worker.join(); }
+        for(size_t f : found) { sum += f; }
+    };
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    concurrent_bubble<uint64_t, 1024> striped(seed);
+    locked_bubble<std::mutex> mutex_bubble{seed.snapshot(), {}};
+    locked_bubble<std::shared_mutex> rw_bubble{seed.snapshot(), {}};
+    for(size_t write_percent : {0, 1, 10, 50}) {
+        for(size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+            std::string suffix = ", " + std::to_string(write_percent) + "% writes x" + std::to_string(threads);
+            report("concurrent_bubble" + suffix, measure([&]() { run(striped, threads, write_percent); }), ops);
+            report("bubble + std::mutex" + suffix, measure([&]() { run(mutex_bubble, threads, write_percent); }), ops);
+            report("bubble + std::shared_mutex" + suffix, measure([&]() { run(rw_bubble, threads, write_percent); }), ops);
+        }
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <random>
+
+int main() {
+    const size_t n = 1000000;
+    std::mt19937_64 rng(29);
+    bubble<uint64_t, 256> source;
+    for(size_t i = 0; i < n; i++) { source.insert(rng()); }
+    uint64_t sum = 0;
+
+    report("bubble<u64, 256> -> <u64, 4096> reinsert", measure([&]() {
+        bubble<uint64_t, 4096> target;
+        for(auto it = source.cbegin(); it != source.cend(); ++it) { target.insert(*it); }
+        sum += target.size();
+    }), n);
+
+    report("bubble<u64, 256> -> <u64, 4096> convert", measure([&]() {
+        bubble<uint64_t, 4096> target(source);
+        sum += target.size();
+    }), n);
+
+    report("bubble<u64, 256> -> <u64, 16> convert", measure([&]() {
+        bubble<uint64_t, 16> target(source);
+        sum += target.size();
+    }), n);
+
+    do_not_optimize(sum);
+    return 0;
+}
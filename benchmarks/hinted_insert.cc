@@ -0,0 +1,87 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000;
+    std::mt19937_64 rng(7);
+    // nearly sorted ingestion, like timestamps arriving slightly out of order: every key is its
+    // position plus a small jitter
+    std::vector<uint64_t> keys(n);
+    for(size_t i = 0; i < n; i++) {
+        keys[i] = i * 16 + rng() % 64;
+    }
+    size_t found = 0;
+
+    {
+        bubble<uint64_t, 1024> b;
+        report("bubble<u64, 1024> insert", measure([&]() {
+            for(auto && key : keys) { b.insert(key); }
+        }), n);
+        report("bubble<u64, 1024> find", measure([&]() {
+            for(auto && key : keys) { found += b.find(key) != b.cend(); }
+        }), n);
+    }
+
+    {
+        bubble<uint64_t, 1024> b;
+        report("bubble<u64, 1024> hinted insert", measure([&]() {
+            auto it = b.cend();
+            for(auto && key : keys) { it = b.insert(it, key).first; }
+        }), n);
+        report("bubble<u64, 1024> hinted find", measure([&]() {
+            auto it = b.cend();
+            for(auto && key : keys) {
+                it = b.find(it, key);
+                found += it != b.cend();
+            }
+        }), n);
+    }
+
+    {
+        std::set<uint64_t> s;
+        report("std::set<u64> hinted insert", measure([&]() {
+            auto it = s.end();
+            for(auto && key : keys) { it = s.insert(it, key); }
+        }), n);
+    }
+
+    // the same keys as long strings with a shared prefix, where every comparison is expensive
+    // and saving them matters more than the extra bookkeeping of the hint
+    std::vector<std::string> names(n);
+    for(size_t i = 0; i < n; i++) {
+        std::string digits = std::to_string(keys[i]);
+        names[i] = "/var/log/service/shard-" + std::string(12 - digits.size(), '0') + digits;
+    }
+
+    {
+        bubble<std::string, 1024> b;
+        report("bubble<string, 1024> insert", measure([&]() {
+            for(auto && name : names) { b.insert(name); }
+        }), n);
+        report("bubble<string, 1024> find", measure([&]() {
+            for(auto && name : names) { found += b.find(name) != b.cend(); }
+        }), n);
+    }
+
+    {
+        bubble<std::string, 1024> b;
+        report("bubble<string, 1024> hinted insert", measure([&]() {
+            auto it = b.cend();
+            for(auto && name : names) { it = b.insert(it, name).first; }
+        }), n);
+        report("bubble<string, 1024> hinted find", measure([&]() {
+            auto it = b.cend();
+            for(auto && name : names) {
+                it = b.find(it, name);
+                found += it != b.cend();
+            }
+        }), n);
+    }
+
+    do_not_optimize(found);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "../src/bubble_mvcc.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000, writes = 100000;
+    std::mt19937_64 rng(31);
+    std::vector<uint64_t> keys(n), updates(writes);
+    for(auto && key : keys) { key = rng(); }
+    for(auto && key : updates) { key = rng(); }
+    uint64_t sum = 0;
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    // one writer inserts and removes, the readers scan the whole bubble until the writer is done.
+    // locked scans hold the writer lock for the whole scan, as a plain bubble behind a mutex would
+    for(bool locked : {false, true}) {
+        for(size_t readers : {0, 1, 2, 4}) {
+            if(locked && readers == 0) { continue; }
+            bubble_mvcc<uint64_t, 1024> b;
+            for(uint64_t key : keys) { b.insert(key); }
+            std::atomic<bool> done{false};
+            std::atomic<size_t> scanned{0};
+            std::vector<double> latency(writes);
+
+            std::vector<std::thread> scans;
+            auto start = std::chrono::steady_clock::now();
+            for(size_t r = 0; r < readers; r++) {
+                scans.emplace_back([&]() {
+                    while(!done) {
+                        size_t count = 0;
+                        auto scan = [&](const auto& keys) {
+                            for(auto it = keys.cbegin(); it != keys.cend(); ++it) { count += *it & 1; }
+                        };
+                        if(locked) { b.write([&](const auto& current) { scan(current); }); }
+                        else { scan(*b.pin()); }
+                        scanned += b.size();
+                        do_not_optimize(count);
+                    }
+                });
+            }
+            double ms = measure([&]() {
+                for(size_t i = 0; i < writes; i++) {
+                    auto op = std::chrono::steady_clock::now();
+                    if(i % 2) { b.remove(updates[i - 1]); }
+                    else { b.insert(updates[i]); }
+                    latency[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - op).count();
+                }
+            });
+            done = true;
+            for(auto && t : scans) { t.join(); }
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::string name = std::string(locked ? "locked scan, " : "pinned scan, ") + std::to_string(readers) + " readers";
+            report(name + ": writes", ms, writes);
+            if(readers > 0) { report(name + ": scanned keys", elapsed, scanned); }
+            std::sort(latency.begin(), latency.end());
+            std::cout << "    write latency p50 " << latency[writes / 2] << " us, p99 " << latency[writes * 99 / 100]
+                      << " us, max " << latency.back() << " us" << '\n';
+            sum += b.size();
+        }
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <random>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000, moves = 1000000;
+    std::mt19937_64 rng(23);
+    // two partitions that trade keys back and forth, as a rebalancing job does
+    std::vector<uint64_t> keys(n);
+    for(auto && key : keys) { key = rng(); }
+    std::vector<size_t> picks(moves);
+    for(auto && pick : picks) { pick = rng() % n; }
+    uint64_t sum = 0;
+
+    auto fill = [&](bubble<uint64_t, 1024>& left, bubble<uint64_t, 1024>& right) {
+        for(size_t i = 0; i < n; i++) { (i % 2 ? right : left).insert(keys[i]); }
+    };
+
+    {
+        bubble<uint64_t, 1024> left, right;
+        fill(left, right);
+        report("bubble<u64, 1024> remove + insert", measure([&]() {
+            for(size_t pick : picks) {
+                uint64_t key = keys[pick];
+                if(left.remove(key)) { right.insert(key); }
+                else if(right.remove(key)) { left.insert(key); }
+            }
+        }), moves);
+        sum += left.size();
+    }
+
+    {
+        bubble<uint64_t, 1024> left, right;
+        fill(left, right);
+        report("bubble<u64, 1024> extract + insert(node)", measure([&]() {
+            for(size_t pick : picks) {
+                uint64_t key = keys[pick];
+                if(auto nh = left.extract(key)) { right.insert(std::move(nh)); }
+                else if(auto nh = right.extract(key)) { left.insert(std::move(nh)); }
+            }
+        }), moves);
+        sum += left.size();
+    }
+
+    {
+        bubble<uint64_t, 1024> left, right;
+        fill(left, right);
+        report("bubble<u64, 1024> merge", measure([&]() { left.merge(right); }), n / 2);
+        sum += left.size();
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
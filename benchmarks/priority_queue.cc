@@ -0,0 +1,60 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <functional>
+#include <queue>
+#include <random>
+#include <set>
+#include <vector>
+
+int main() {
+    const size_t warmup = 100000, n = 2000000;
+    std::mt19937_64 rng(7);
+    // a scheduler: every step pops the earliest deadline and pushes a new one a bit later than
+    // the current time, so the queue keeps about warmup entries
+    std::vector<uint64_t> delays(warmup + n);
+    for(auto && delay : delays) {
+        delay = 1 + rng() % 1000000;
+    }
+    uint64_t sum = 0;
+
+    {
+        bubble<uint64_t, 1024> b;
+        report("bubble<u64, 1024> push/pop_min", measure([&]() {
+            for(size_t i = 0; i < warmup; i++) { b.insert(delays[i] * 64 + i % 64); }
+            for(size_t i = warmup; i < warmup + n; i++) {
+                uint64_t now = b.pop_min();
+                sum += now;
+                b.insert(now + delays[i] * 64 + i % 64);
+            }
+        }), n);
+    }
+
+    {
+        std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<>> q;
+        report("std::priority_queue<u64> push/pop", measure([&]() {
+            for(size_t i = 0; i < warmup; i++) { q.push(delays[i] * 64 + i % 64); }
+            for(size_t i = warmup; i < warmup + n; i++) {
+                uint64_t now = q.top();
+                q.pop();
+                sum += now;
+                q.push(now + delays[i] * 64 + i % 64);
+            }
+        }), n);
+    }
+
+    {
+        std::set<uint64_t> s;
+        report("std::set<u64> insert/erase(begin)", measure([&]() {
+            for(size_t i = 0; i < warmup; i++) { s.insert(delays[i] * 64 + i % 64); }
+            for(size_t i = warmup; i < warmup + n; i++) {
+                uint64_t now = *s.begin();
+                s.erase(s.begin());
+                sum += now;
+                s.insert(now + delays[i] * 64 + i % 64);
+            }
+        }), n);
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+* @brief one line of a billing rollup, keyed by id and summed by amount
+*/
+struct charge {
+    uint64_t id;
+    double amount;
+};
+
+int main() {
+    const size_t n = 1000000, queries = 200;
+    std::mt19937_64 rng(7);
+    std::vector<charge> charges(n);
+    for(auto && c : charges) {
+        c = charge{rng() % (n * 16), static_cast<double>(rng() % 10000) / 100};
+    }
+    std::vector<std::pair<uint64_t, uint64_t>> ranges(queries);
+    for(auto && [first, last] : ranges) {
+        first = rng() % (n * 16);
+        last = first + rng() % (n * 4);
+    }
+    double total = 0;
+
+    bubble<charge, 1024, std::less<>, &charge::id> plain;
+    bubble<charge, 1024, std::less<>, &charge::id, sum_min_max<double, &charge::amount>> summed;
+    report("bubble<charge, 1024> insert", measure([&]() {
+        for(auto && c : charges) { plain.insert(c); }
+    }), n);
+    report("bubble<charge, 1024, sum_min_max> insert", measure([&]() {
+        for(auto && c : charges) { summed.insert(c); }
+    }), n);
+
+    report("bubble<charge, 1024> scan range()", measure([&]() {
+        for(auto && [first, last] : ranges) {
+            for(auto && c : plain.range(first, last)) { total += c.amount; }
+        }
+    }), queries);
+    report("bubble<charge, 1024, sum_min_max> sum()", measure([&]() {
+        for(auto && [first, last] : ranges) { total += summed.sum(first, last); }
+    }), queries);
+    report("bubble<charge, 1024, sum_min_max> max_below()", measure([&]() {
+        for(auto && [first, last] : ranges) { total += summed.max_below(last).value_or(0); }
+    }), queries);
+
+    do_not_optimize(total);
+    return 0;
+}
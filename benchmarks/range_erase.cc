@@ -0,0 +1,57 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <random>
+#include <set>
+#include <vector>
+
+int main() {
+    const size_t window = 200000, n = 2000000, batch = 20000;
+    std::mt19937_64 rng(9);
+    // a sliding window over timestamps that arrive slightly out of order, after every batch all
+    // keys older than the watermark are dropped
+    std::vector<uint64_t> stamps(n);
+    for(size_t i = 0; i < n; i++) {
+        stamps[i] = i * 16 + rng() % 4096;
+    }
+    uint64_t sum = 0;
+
+    {
+        bubble<uint64_t, 1024> b;
+        report("bubble<u64, 1024> remove per key", measure([&]() {
+            size_t expired = 0;
+            for(size_t i = 0; i < n; i++) {
+                b.insert(stamps[i]);
+                if((i + 1) % batch == 0 && i >= window) {
+                    uint64_t watermark = (i - window) * 16;
+                    for(; expired < n && stamps[expired] < watermark; expired++) { b.remove(stamps[expired]); }
+                }
+            }
+            sum += b.size();
+        }), n);
+    }
+
+    {
+        bubble<uint64_t, 1024> b;
+        report("bubble<u64, 1024> erase_below", measure([&]() {
+            for(size_t i = 0; i < n; i++) {
+                b.insert(stamps[i]);
+                if((i + 1) % batch == 0 && i >= window) { b.erase_below((i - window) * 16); }
+            }
+            sum += b.size();
+        }), n);
+    }
+
+    {
+        std::set<uint64_t> s;
+        report("std::set<u64> erase(begin, lower_bound)", measure([&]() {
+            for(size_t i = 0; i < n; i++) {
+                s.insert(stamps[i]);
+                if((i + 1) % batch == 0 && i >= window) { s.erase(s.begin(), s.lower_bound((i - window) * 16)); }
+            }
+            sum += s.size();
+        }), n);
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000;
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> keys(n);
+    for(auto && key : keys) {
+        key = rng() % (n * 16);
+    }
+    bubble<uint64_t, 1024> b;
+    std::set<uint64_t> s;
+    for(auto && key : keys) {
+        b.insert(key);
+        s.insert(key);
+    }
+    uint64_t sum = 0;
+
+    // every query sums the keys in [a, a + width), the wider the window the more the cost is
+    // the walk itself instead of locating its start
+    for(uint64_t width : {16, 1024, 65536}) {
+        std::vector<uint64_t> starts(std::min<uint64_t>(20000, 8000000 / width));
+        for(auto && start : starts) {
+            start = rng() % (n * 16);
+        }
+        size_t scanned = 0;
+        for(auto && start : starts) {
+            scanned += std::distance(s.lower_bound(start), s.lower_bound(start + width));
+        }
+
+        report("bubble<u64, 1024> range width " + std::to_string(width), measure([&]() {
+            for(auto && start : starts) {
+                for(uint64_t key : b.range(start, start + width)) { sum += key; }
+            }
+        }), scanned);
+        report("std::set<u64> range width " + std::to_string(width), measure([&]() {
+            for(auto && start : starts) {
+                auto last = s.lower_bound(start + width);
+                for(auto it = s.lower_bound(start); it != last; ++it) { sum += *it; }
+            }
+        }), scanned);
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "../src/concurrent_bubble.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000, searches = 200000, readers = 2, batch = 1000;
+    std::mt19937_64 rng(41);
+    bubble<uint64_t, 1024> seed;
+    std::vector<uint64_t> present(n), fresh(n);
+    for(auto && key : present) { key = rng(); seed.insert(key); }
+    for(auto && key : fresh) { key = rng(); }
+    uint64_t sum = 0;
+
+    // readers time every search while one writer inserts and removes fresh keys until they finish
+    auto run = [&](const std::string& name, auto&& search, auto&& write) {
+        std::atomic<bool> done{false};
+        std::thread writer([&]() {
+            for(size_t i = 0; !done; i = (i + batch) % n) { write(i); }
+        });
+        std::vector<std::vector<double>> latency(readers, std::vector<double>(searches));
+        std::vector<std::thread> threads;
+        for(size_t r = 0; r < readers; r++) {
+            threads.emplace_back([&, r]() {
+                for(size_t i = 0; i < searches; i++) {
+                    auto start = std::chrono::steady_clock::now();
+                    sum += search(present[(i * 31 + r) % n]);
+                    latency[r][i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                }
+            });
+        }
+        for(auto && t : threads) { t.join(); }
+        done = true;
+        writer.join();
+        std::vector<double> all;
+        for(auto && l : latency) { all.insert(all.end(), l.begin(), l.end()); }
+        std::sort(all.begin(), all.end());
+        std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(0)
+                  << " p50 " << all[all.size() / 2] << " ns, p99 " << all[all.size() * 99 / 100] << " ns, p99.9 "
+                  << all[all.size() * 999 / 1000] << " ns, max " << all.back() << " ns" << '\n';
+    };
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    {
+        concurrent_bubble<uint64_t, 1024> b(seed);
+        run("concurrent_bubble", [&](uint64_t key) { return b.search(key); }, [&](size_t first) {
+            for(size_t i = first; i < first + batch; i++) { b.insert(fresh[i]); }
+            for(size_t i = first; i < first + batch; i++) { b.remove(fresh[i]); }
+        });
+        run("concurrent_bubble, writer rebalances", [&](uint64_t key) { return b.search(key); }, [&](size_t) { b.rebalance(); });
+    }
+    {
+        bubble<uint64_t, 1024> b = seed.snapshot();
+        std::shared_mutex lock;
+        auto search = [&](uint64_t key) {
+            std::shared_lock<std::shared_mutex> guard(lock);
+            return b.search(key);
+        };
+        run("bubble + std::shared_mutex, lock per write", search, [&](size_t first) {
+            for(size_t i = first; i < first + batch; i++) {
+                std::unique_lock<std::shared_mutex> guard(lock);
+                b.insert(fresh[i]);
+            }
+            for(size_t i = first; i < first + batch; i++) {
+                std::unique_lock<std::shared_mutex> guard(lock);
+                b.remove(fresh[i]);
+            }
+        });
+        run("bubble + std::shared_mutex, lock per batch", search, [&](size_t first) {
+            std::unique_lock<std::shared_mutex> guard(lock);
+            for(size_t i = first; i < first + batch; i++) { b.insert(fresh[i]); }
+            for(size_t i = first; i < first + batch; i++) { b.remove(fresh[i]); }
+        });
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
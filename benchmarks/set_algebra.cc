@@ -0,0 +1,56 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000;
+    std::mt19937_64 rng(17);
+    // two key sets of n keys each drawn from the same space, about a third of them overlap
+    std::vector<uint64_t> left(n), right(n);
+    for(auto && key : left) { key = rng() % (n * 6); }
+    for(auto && key : right) { key = rng() % (n * 6); }
+    bubble<uint64_t, 1024> a, b;
+    for(uint64_t key : left) { a.insert(key); }
+    for(uint64_t key : right) { b.insert(key); }
+    std::vector<uint64_t> sorted_a(a.cbegin(), a.cend()), sorted_b(b.cbegin(), b.cend());
+    uint64_t sum = 0;
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    {
+        bubble<uint64_t, 1024> result;
+        report("bubble<u64, 1024> iterate + search", measure([&]() {
+            for(auto it = a.cbegin(); it != a.cend(); ++it) {
+                if(b.search(*it)) { result.append(*it); }
+            }
+        }), a.size() + b.size());
+        sum += result.size();
+    }
+
+    for(size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        report("bubble<u64, 1024> set_intersection x" + std::to_string(threads), measure([&]() {
+            sum += bubble<uint64_t, 1024>::set_intersection(a, b, threads).size();
+        }), a.size() + b.size());
+    }
+
+    for(size_t threads : {1, 8}) {
+        report("bubble<u64, 1024> set_union x" + std::to_string(threads), measure([&]() {
+            sum += bubble<uint64_t, 1024>::set_union(a, b, threads).size();
+        }), a.size() + b.size());
+    }
+
+    {
+        std::vector<uint64_t> result;
+        report("std::set_intersection on sorted vectors", measure([&]() {
+            std::set_intersection(sorted_a.begin(), sorted_a.end(), sorted_b.begin(), sorted_b.end(), std::back_inserter(result));
+        }), sorted_a.size() + sorted_b.size());
+        sum += result.size();
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
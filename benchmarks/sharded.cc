@@ -0,0 +1,58 @@
+#include "../src/sharded_bubble.h"
+#include "benchmark.h"
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000, ops = 512000, batch = 1024, in_flight = 8;
+    std::mt19937_64 rng(47);
+    bubble<uint64_t, 1024> seed;
+    std::vector<uint64_t> present(n), fresh(ops);
+    for(auto && key : present) { key = rng(); seed.insert(key); }
+    for(auto && key : fresh) { key = rng(); }
+    uint64_t sum = 0;
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    bubble<uint64_t, 1024> single = seed.snapshot();
+    report("bubble, insert + remove", measure([&]() {
+        for(uint64_t key : fresh) { sum += single.insert(key).second; }
+        for(uint64_t key : fresh) { sum += single.remove(key); }
+    }), 2 * ops);
+    report("bubble, search", measure([&]() {
+        for(size_t i = 0; i < ops; i++) { sum += single.search(present[i * 13 % n]); }
+    }), ops);
+
+    // keeps in_flight batches queued so the shards never wait for the caller
+    auto pipeline = [&](auto&& submit) {
+        std::deque<decltype(submit(size_t(0)))> pending;
+        for(size_t first = 0; first < ops; first += batch) {
+            pending.push_back(submit(first));
+            if(pending.size() == in_flight) {
+                do_not_optimize(pending.front().get());
+                pending.pop_front();
+            }
+        }
+        for(auto && f : pending) { do_not_optimize(f.get()); }
+    };
+    for(size_t shards : {1, 2, 4, 8}) {
+        sharded_bubble<uint64_t, 1024> sharded(seed.snapshot(), shards);
+        std::string suffix = ", " + std::to_string(shards) + " shards";
+        report("sharded_bubble, insert + remove" + suffix, measure([&]() {
+            pipeline([&](size_t first) { return sharded.insert(std::vector<uint64_t>(fresh.begin() + first, fresh.begin() + first + batch)); });
+            pipeline([&](size_t first) { return sharded.remove(std::vector<uint64_t>(fresh.begin() + first, fresh.begin() + first + batch)); });
+        }), 2 * ops);
+        report("sharded_bubble, search" + suffix, measure([&]() {
+            pipeline([&](size_t first) {
+                std::vector<uint64_t> keys(batch);
+                for(size_t i = 0; i < batch; i++) { keys[i] = present[(first + i) * 13 % n]; }
+                return sharded.search(std::move(keys));
+            });
+        }), ops);
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
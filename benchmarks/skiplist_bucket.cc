@@ -0,0 +1,57 @@
+#include "../src/concurrent_bubble.h"
+#include "benchmark.h"
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000, ops = 128000;
+    std::mt19937_64 rng(41);
+    bubble<uint64_t, 1024> seed;
+    std::vector<uint64_t> present(n), fresh(ops), hot(ops);
+    for(auto && key : present) { key = rng(); seed.insert(key); }
+    for(auto && key : fresh) { key = rng(); }
+    // keys between two neighbouring pivots, so every writer goes to the same bucket
+    uint64_t low = seed.get_key(512), width = seed.get_key(513) - low;
+    for(auto && key : hot) { key = low + 1 + rng() % (width - 1); }
+    uint64_t sum = 0;
+
+    // every thread runs ops / threads operations, a write inserts a key and removes it again so
+    // the size stays put, a read searches a key that exists
+    auto run = [&](auto& b, const std::vector<uint64_t>& writes, size_t threads, size_t write_percent) {
+        std::vector<std::thread> workers;
+        std::vector<size_t> found(threads);
+        for(size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                for(size_t i = t; i < ops; i += threads) {
+                    if(i * 7 % 100 < write_percent) {
+                        b.insert(writes[i]);
+                        b.remove(writes[i]);
+                    }
+                    else {
+                        found[t] += b.search(present[i * 13 % n]);
+                    }
+                }
+            });
+        }
+        for(auto && worker : workers) { worker.join(); }
+        for(size_t f : found) { sum += f; }
+    };
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    concurrent_bubble<uint64_t, 1024> avl(seed);
+    concurrent_bubble<uint64_t, 1024, std::less<>, std::identity{}, lockfree_skiplist> skiplist(seed);
+    for(size_t write_percent : {50, 100}) {
+        for(size_t threads : {1, 4, 16, 64}) {
+            std::string suffix = ", " + std::to_string(write_percent) + "% writes x" + std::to_string(threads);
+            report("cow_avl_bucket spread" + suffix, measure([&]() { run(avl, fresh, threads, write_percent); }), ops);
+            report("lockfree_skiplist spread" + suffix, measure([&]() { run(skiplist, fresh, threads, write_percent); }), ops);
+            report("cow_avl_bucket one bucket" + suffix, measure([&]() { run(avl, hot, threads, write_percent); }), ops);
+            report("lockfree_skiplist one bucket" + suffix, measure([&]() { run(skiplist, hot, threads, write_percent); }), ops);
+        }
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
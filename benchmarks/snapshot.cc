@@ -0,0 +1,70 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <random>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000, writes = 200000, snapshots = 1000;
+    std::mt19937_64 rng(29);
+    std::vector<uint64_t> keys(n), updates(writes);
+    for(auto && key : keys) { key = rng(); }
+    for(auto && key : updates) { key = rng(); }
+    uint64_t sum = 0;
+
+    auto fill = [&](bubble<uint64_t, 1024>& b) {
+        for(uint64_t key : keys) { b.insert(key); }
+    };
+
+    {
+        bubble<uint64_t, 1024> b;
+        fill(b);
+        report("bubble<u64, 1024> insert", measure([&]() {
+            for(uint64_t key : updates) { b.insert(key); }
+        }), writes);
+        sum += b.size();
+    }
+
+    {
+        bubble<uint64_t, 1024> b;
+        fill(b);
+        bubble<uint64_t, 1024> frozen = b.snapshot();
+        // every write copies the path it touches the first time, later writes reuse the copies
+        report("bubble<u64, 1024> insert, live snapshot", measure([&]() {
+            for(uint64_t key : updates) { b.insert(key); }
+        }), writes);
+        sum += b.size() + frozen.size();
+    }
+
+    {
+        bubble<uint64_t, 1024> b;
+        fill(b);
+        std::vector<bubble<uint64_t, 1024>> taken;
+        taken.reserve(snapshots);
+        // a snapshot every writes / snapshots inserts, all of them kept alive
+        report("bubble<u64, 1024> insert, snapshot per 200", measure([&]() {
+            for(size_t i = 0; i < writes; i++) {
+                if(i % (writes / snapshots) == 0) { taken.push_back(b.snapshot()); }
+                b.insert(updates[i]);
+            }
+        }), writes);
+        sum += taken.back().size();
+    }
+
+    {
+        bubble<uint64_t, 1024> b;
+        fill(b);
+        report("bubble<u64, 1024> snapshot", measure([&]() {
+            for(size_t i = 0; i < snapshots; i++) { sum += b.snapshot().size(); }
+        }), snapshots);
+        report("bubble<u64, 1024> deep copy", measure([&]() {
+            for(size_t i = 0; i < 10; i++) {
+                bubble<uint64_t, 1024> copy;
+                for(auto it = b.cbegin(); it != b.cend(); ++it) { copy.append(*it); }
+                sum += copy.size();
+            }
+        }), 10);
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "../src/bubble.h"
+#include "benchmark.h"
+#include <random>
+#include <vector>
+
+int main() {
+    const size_t n = 1000000, shards = 16, rounds = 20, rebuilds = 2;
+    std::mt19937_64 rng(13);
+    std::vector<uint64_t> keys(n);
+    for(auto && key : keys) {
+        key = rng() % (n * 64);
+    }
+    uint64_t sum = 0;
+
+    // resharding: cut the index into shards at fresh boundaries and put it back together. The
+    // operation count is the number of shards produced, so the two rows compare directly
+    {
+        bubble<uint64_t, 1024> b;
+        for(uint64_t key : keys) { b.insert(key); }
+        report("bubble<u64, 1024> split/concat", measure([&]() {
+            for(size_t r = 0; r < rounds; r++) {
+                std::vector<bubble<uint64_t, 1024>> parts;
+                for(size_t s = shards - 1; s > 0; s--) { parts.push_back(b.split((n * 64 / shards) * s + r)); }
+                for(size_t s = parts.size(); s-- > 0;) { b.concat(std::move(parts[s])); }
+                sum += b.size();
+            }
+        }), rounds * shards);
+    }
+
+    {
+        bubble<uint64_t, 1024> b;
+        for(uint64_t key : keys) { b.insert(key); }
+        report("bubble<u64, 1024> rebuild by insert", measure([&]() {
+            for(size_t r = 0; r < rebuilds; r++) {
+                std::vector<bubble<uint64_t, 1024>> parts(shards);
+                for(auto it = b.cbegin(); it != b.cend(); ++it) { parts[*it / (n * 64 / shards)].insert(*it); }
+                bubble<uint64_t, 1024> merged;
+                for(auto && part : parts) {
+                    for(auto it = part.cbegin(); it != part.cend(); ++it) { merged.insert(*it); }
+                }
+                b = merged;
+                sum += b.size();
+            }
+        }), rebuilds * shards);
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
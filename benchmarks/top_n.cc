@@ -0,0 +1,67 @@
+#include "../src/bubble_top_n.h"
+#include "benchmark.h"
+#include <functional>
+#include <queue>
+#include <random>
+#include <set>
+#include <vector>
+
+int main() {
+    const size_t capacity = 10000, n = 4000000;
+    std::mt19937_64 rng(5);
+    // a stream of scores whose level slowly rises, so a good share of the keys still displaces
+    // the current minimum instead of being rejected right away
+    std::vector<uint64_t> scores(n);
+    for(size_t i = 0; i < n; i++) {
+        scores[i] = i * 4 + rng() % (1u << 22);
+    }
+    uint64_t sum = 0;
+
+    {
+        bubble<uint64_t, 1024> b;
+        report("bubble<u64, 1024> insert/remove(min)", measure([&]() {
+            for(uint64_t score : scores) {
+                if(b.size() < capacity) { b.insert(score); continue; }
+                if(score <= b.min()) { continue; }
+                if(b.insert(score).second) { b.pop_min(); }
+            }
+            sum += b.min();
+        }), n);
+    }
+
+    {
+        bubble_top_n<uint64_t, 1024> top(capacity);
+        report("bubble_top_n<u64, 1024> insert", measure([&]() {
+            for(uint64_t score : scores) { top.insert(score); }
+            sum += top.min();
+        }), n);
+    }
+
+    {
+        std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<>> q;
+        report("std::priority_queue<u64> push/pop", measure([&]() {
+            for(uint64_t score : scores) {
+                if(q.size() < capacity) { q.push(score); continue; }
+                if(score <= q.top()) { continue; }
+                q.pop();
+                q.push(score);
+            }
+            sum += q.top();
+        }), n);
+    }
+
+    {
+        std::set<uint64_t> s;
+        report("std::set<u64> insert/erase(begin)", measure([&]() {
+            for(uint64_t score : scores) {
+                if(s.size() < capacity) { s.insert(score); continue; }
+                if(score <= *s.begin()) { continue; }
+                if(s.insert(score).second) { s.erase(s.begin()); }
+            }
+            sum += *s.begin();
+        }), n);
+    }
+
+    do_not_optimize(sum);
+    return 0;
+}
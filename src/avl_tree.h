@@ -2,18 +2,189 @@
 #define AVL_TREE_H
 
 #ifdef __cplusplus
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <queue>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #endif
 
+namespace bubble_detail {
+template <typename K>
+concept has_spaceship = requires(const K &a, const K &b) {
+  { a <=> b } -> std::convertible_to<std::partial_ordering>;
+};
+
+/**
+ *@brief three-way comparison of two keys under Compare.
+ *Comparators that already return an ordering are called once, std::less and
+ *std::greater are mapped to a single operator<=> when the key supports it and
+ *anything else falls back to two calls of the strict weak ordering.
+ *@returns an ordering that compares against 0: < 0, == 0 or > 0.
+ */
+template <typename Compare, typename K>
+constexpr auto three_way(const Compare &comp, const K &a, const K &b) {
+  if constexpr (std::convertible_to<std::invoke_result_t<const Compare &, const K &, const K &>,
+                                    std::partial_ordering>) {
+    return comp(a, b);
+  } else if constexpr (has_spaceship<K> &&
+                       (std::same_as<Compare, std::less<>> ||
+                        std::same_as<Compare, std::less<K>>)) {
+    return a <=> b;
+  } else if constexpr (has_spaceship<K> &&
+                       (std::same_as<Compare, std::greater<>> ||
+                        std::same_as<Compare, std::greater<K>>)) {
+    return b <=> a;
+  } else {
+    if (comp(a, b)) {
+      return std::weak_ordering::less;
+    }
+    if (comp(b, a)) {
+      return std::weak_ordering::greater;
+    }
+    return std::weak_ordering::equivalent;
+  }
+}
+
+/**
+ *@brief owning pointer to a node that keeps its own reference count in an
+ *std::atomic<size_t> refs member, so no control block is allocated and a
+ *copy costs one increment. use_count() loads the count with acquire order:
+ *an owner that finds itself alone also sees everything the other owners did
+ *with the node before they let it go.
+ */
+template <typename N> class counted_ptr {
+public:
+  constexpr counted_ptr() noexcept = default;
+  constexpr counted_ptr(std::nullptr_t) noexcept {}
+  counted_ptr(const counted_ptr &p) noexcept : _p(p._p) {
+    if (_p) {
+      _p->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  counted_ptr(counted_ptr &&p) noexcept : _p(std::exchange(p._p, nullptr)) {}
+  ~counted_ptr() {
+    if (_p && _p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete _p;
+    }
+  }
+
+  counted_ptr &operator=(const counted_ptr &p) noexcept {
+    counted_ptr(p).swap(*this);
+    return *this;
+  }
+  counted_ptr &operator=(counted_ptr &&p) noexcept {
+    counted_ptr(std::move(p)).swap(*this);
+    return *this;
+  }
+
+  /**
+   *@brief allocates an N from args, owned by the returned pointer alone.
+   */
+  template <typename... Args> static counted_ptr make(Args &&...args) {
+    counted_ptr p;
+    p._p = new N(std::forward<Args>(args)...);
+    p._p->refs.store(1, std::memory_order_relaxed);
+    return p;
+  }
+
+  N *get() const noexcept { return _p; }
+  N &operator*() const noexcept { return *_p; }
+  N *operator->() const noexcept { return _p; }
+  explicit operator bool() const noexcept { return _p != nullptr; }
+  size_t use_count() const noexcept {
+    return _p ? _p->refs.load(std::memory_order_acquire) : 0;
+  }
+  void swap(counted_ptr &p) noexcept { std::swap(_p, p._p); }
+
+  friend bool operator==(const counted_ptr &a, const counted_ptr &b) noexcept {
+    return a._p == b._p;
+  }
+  friend bool operator==(const counted_ptr &a, std::nullptr_t) noexcept {
+    return a._p == nullptr;
+  }
+
+private:
+  N *_p{nullptr};
+};
+} // namespace bubble_detail
+
+/**
+ *@brief the default aggregate policy, nodes store nothing extra.
+ *An aggregate policy provides a value_type, identity(), lift(const T&) that
+ *maps one element to a value and an associative combine(a, b) that merges the
+ *values of two neighbouring ranges, left one first.
+ */
+struct no_aggregate {
+  struct value_type {};
+  static constexpr value_type identity() { return {}; }
+  template <typename T> static constexpr value_type lift(const T &) {
+    return {};
+  }
+  static constexpr value_type combine(value_type, value_type) { return {}; }
+};
+
+/**
+ *@brief aggregate policy that keeps the sum, the minimum and the maximum of a
+ *numeric value of every subtree.
+ *@tparam V: the arithmetic type of the value.
+ *@tparam Value: callable or member pointer that maps a stored T to its value,
+ *e.g. &Invoice::amount. Defaults to the identity.
+ */
+template <typename V, auto Value = std::identity{}> struct sum_min_max {
+  struct value_type {
+    V sum;
+    V min;
+    V max;
+  };
+  static constexpr value_type identity() {
+    return {V{}, std::numeric_limits<V>::max(),
+            std::numeric_limits<V>::lowest()};
+  }
+  template <typename T> static constexpr value_type lift(const T &key) {
+    V v = static_cast<V>(std::invoke(Value, key));
+    return {v, v, v};
+  }
+  static constexpr value_type combine(const value_type &a,
+                                      const value_type &b) {
+    return {a.sum + b.sum, std::min(a.min, b.min), std::max(a.max, b.max)};
+  }
+};
+
 /**
  *@brief Class for AVL tree.
+ *@tparam Compare: strict weak ordering applied to the projected keys.
+ *@tparam Projection: callable or member pointer that maps a stored T to the
+ *key that is compared, e.g. &Order::id. Defaults to the identity.
+ *@tparam Aggregate: policy whose value every node keeps for its subtree, see
+ *no_aggregate. Rotations and removals keep it current.
  */
-template <typename T> class avl_tree {
+template <typename T, typename Compare = std::less<>,
+          auto Projection = std::identity{}, typename Aggregate = no_aggregate>
+class avl_tree {
 public:
+  /**
+   *@brief type of the value that Aggregate keeps for every subtree.
+   */
+  using aggregate_type = typename Aggregate::value_type;
+  static constexpr bool has_aggregate = !std::same_as<Aggregate, no_aggregate>;
+
+  /**
+   *@brief type of the projected key that every comparison is done on.
+   */
+  using key_type = std::remove_cvref_t<
+      std::invoke_result_t<decltype(Projection), const T &>>;
+
   /**
    *@brief Contructor for AVL tree class.
    *@param __elements: you can directly pass a vector<T> so you don't have to do
@@ -28,22 +199,49 @@ public:
   }
 
   /**
-   * @brief Copy constructor for avl tree class
+   * @brief Copy constructor for avl tree class, O(1). The two trees share
+   * every node and each write copies only the nodes on its path that the
+   * other tree still references, so neither tree ever sees the other's
+   * changes.
    * @param a the tree we want to copy
    */
-  explicit avl_tree(const avl_tree &a) noexcept : root(a.root), _size(a._size) {
-
+  avl_tree(const avl_tree &a) noexcept
+      : root(a.root), _size(a._size), _comp(a._comp) {}
 
+  /**
+   * @brief Move constructor for avl tree class, a is left empty.
+   */
+  avl_tree(avl_tree &&a) noexcept
+      : root(std::move(a.root)), _size(std::exchange(a._size, 0)),
+        _comp(a._comp) {
+    a._version++;
   }
 
   /**
-   * @brief operator = for avl tree class
+   * @brief operator = for avl tree class, shares the nodes of a like the
+   * copy constructor.
    * @param a the tree we want to copy
    * @return avl_tree&
    */
   avl_tree &operator=(const avl_tree &a) noexcept {
     root = a.root;
     _size = a._size;
+    _comp = a._comp;
+    _version++;
+    return *this;
+  }
+
+  /**
+   * @brief move assignment for avl tree class, a is left empty.
+   */
+  avl_tree &operator=(avl_tree &&a) noexcept {
+    if (this != &a) {
+      root = std::move(a.root);
+      _size = std::exchange(a._size, 0);
+      _comp = a._comp;
+      _version++;
+      a._version++;
+    }
     return *this;
   }
 
@@ -53,13 +251,190 @@ public:
    */
   ~avl_tree() noexcept {}
 
+  /**
+   *@brief in-order iterator that also serves as a finger for hinted
+   *operations.
+   */
+  class const_iterator;
+
+  /**
+   *@brief owner of a node that is not linked into any tree, in the style of
+   *std::set::node_type. The key can be changed through value() and the node
+   *inserted again without allocating.
+   */
+  class node_handle;
+
+  /**
+   *@brief result of inserting a node_handle, node is empty unless the key
+   *already existed.
+   */
+  struct insert_return_type;
+
   /**
    *@brief insert function.
    *@param key: key to be inserted.
+   *@returns std::pair<const_iterator, bool>: an iterator to the element with
+   *that key and true if key was not already in the tree.
+   */
+  std::pair<const_iterator, bool> insert(T key) {
+    const key_type &k = _proj(key);
+    return find_or_insert(k, [&]() { return std::move(key); });
+  }
+
+  /**
+   *@brief hinted insert function, the search starts from hint and climbs only
+   *as far as needed, so inserting next to the hint costs O(log d) comparisons
+   *where d is the distance from it.
+   *@param hint: an iterator of this tree, ignored if the tree changed since it
+   *was obtained.
+   *@param key: key to be inserted.
+   *@returns std::pair<const_iterator, bool>: an iterator to the element with
+   *that key and true if key was not already in the tree.
+   */
+  std::pair<const_iterator, bool> insert(const const_iterator &hint, T key) {
+    const key_type &k = _proj(key);
+    return find_or_insert(hint, k, [&]() { return std::move(key); });
+  }
+
+  /**
+   *@brief find_or_insert function, looks key up and creates its element in
+   *the same descent if it does not exist. A key that exists leaves the tree
+   *untouched, so its element may still be shared with a copy of this tree.
+   *@param key: key to be searched.
+   *@param make: callable that returns the T to insert, it is only invoked
+   *when key is missing and the projection of its result must equal key.
+   *@returns std::pair<const_iterator, bool>: an iterator to the element with
+   *that key and true if it was created.
+   */
+  template <typename F>
+  std::pair<const_iterator, bool> find_or_insert(const key_type &key,
+                                                 F &&make) {
+    return _insert_at(trail(), key, make, false);
+  }
+
+  /**
+   *@brief find_or_insert_unshared function, a find_or_insert for elements
+   *whose mutable members are about to change. An element that already exists
+   *is shared with no copy of this tree afterwards, like with find_unshared.
+   */
+  template <typename F>
+  std::pair<const_iterator, bool> find_or_insert_unshared(const key_type &key,
+                                                          F &&make) {
+    return _insert_at(trail(), key, make, true);
+  }
+
+  /**
+   *@brief hinted find_or_insert function.
+   *@param hint: an iterator of this tree, ignored if the tree changed since it
+   *was obtained.
+   */
+  template <typename F>
+  std::pair<const_iterator, bool> find_or_insert(const const_iterator &hint,
+                                                 const key_type &key,
+                                                 F &&make) {
+    return _insert_at(_finger(hint, key), key, make, false);
+  }
+
+  /**
+   *@brief append function, inserts key behind the biggest key of the tree.
+   *It walks the right spine without comparing, compares key once against the
+   *last key and retraces only the spine, which stops at the first node whose
+   *height did not change.
+   *@param key: key to be appended.
+   *@returns std::pair<const_iterator, bool>: an iterator to the new element
+   *and true, or cend() and false if key is not bigger than every key of the
+   *tree, in which case the tree is left unchanged.
    */
-  void insert(T key) {
-    root = _insert(root, key);
+  std::pair<const_iterator, bool> append(T key) {
+    trail it;
+    if (!root) {
+      root = createNode(std::move(key));
+      it.push(root.get());
+    } else {
+      it.push_rightmost(root.get());
+      if (_compare(_proj(key), _proj(it.top()->info)) <= 0) {
+        return {cend(), false};
+      }
+      _own_path(it);
+      node *tail = const_cast<node *>(it.top());
+      tail->right = createNode(std::move(key));
+      it.push(tail->right.get());
+      _count_path(it);
+      _retrace(it, _proj(it.top()->info));
+      _aggregate_path(it);
+    }
     _size++;
+    _version++;
+    return {const_iterator(this, it), true};
+  }
+
+  /**
+   *@brief join function, builds the tree that holds every key of left, pivot
+   *and every key of right in O(|height(left) - height(right)| + 1) time. The
+   *nodes are relinked, not copied, and left and right are left empty.
+   *@param left: tree whose keys are all smaller than pivot.
+   *@param pivot: the key in between.
+   *@param right: tree whose keys are all bigger than pivot.
+   *@returns avl_tree: the joined tree.
+   */
+  static avl_tree join(avl_tree &&left, T pivot, avl_tree &&right) {
+    avl_tree t;
+    t.root = t._join(std::move(left.root), t.createNode(std::move(pivot)),
+                     std::move(right.root));
+    t._size = left._size + right._size + 1;
+    left.clear();
+    right.clear();
+    return t;
+  }
+
+  /**
+   *@brief join function without a pivot, the smallest key of right takes its
+   *place. Costs O(log n) and leaves left and right empty.
+   *@param left: tree whose keys are all smaller than the keys of right.
+   *@param right: the other tree.
+   *@returns avl_tree: the joined tree.
+   */
+  static avl_tree join(avl_tree &&left, avl_tree &&right) {
+    avl_tree t;
+    t.root = t._join(std::move(left.root), std::move(right.root));
+    t._size = left._size + right._size;
+    left.clear();
+    right.clear();
+    return t;
+  }
+
+  /**
+   *@brief from_sorted function, builds a balanced tree from strictly
+   *increasing keys in O(n) without comparing them.
+   *@param first: the first key.
+   *@param last: the end of the keys.
+   *@returns avl_tree: the tree that holds every key of [first, last).
+   */
+  template <std::input_iterator It>
+  static avl_tree from_sorted(It first, It last) {
+    avl_tree t;
+    std::vector<node_ptr> nodes;
+    for (; first != last; ++first) {
+      nodes.push_back(t.createNode(*first));
+    }
+    t.root = _build(nodes, 0, nodes.size());
+    t._size = nodes.size();
+    return t;
+  }
+
+  /**
+   *@brief split function, moves every key that is not smaller than key into
+   *a new tree in O(log n). The nodes are relinked, not copied.
+   *@param key: the first key that moves.
+   *@returns avl_tree: the keys not smaller than key, this keeps the rest.
+   */
+  avl_tree split(const key_type &key) {
+    avl_tree t;
+    std::tie(root, t.root) = _split(std::move(root), key);
+    t._size = count(t.root);
+    _size -= t._size;
+    _version++;
+    return t;
   }
 
   /**
@@ -69,6 +444,7 @@ public:
   void clear() {
     root = nullptr;
     _size = 0;
+    _version++;
     return;
   }
 
@@ -79,12 +455,227 @@ public:
   */
   T get_root() const { return this->root->info; }
 
+  /**
+   * @brief get_min function
+   * @return T: the smallest element of the tree
+   * Created for bubble.h container
+   */
+  T get_min() const { return minValue(root)->info; }
+
   /**
    *@brief search function.
    *@param key: key to be searched.
    *@returns true if the key exists in the tree.
    */
-  bool search(T key) { return _search(root, key); }
+  bool search(const key_type &key) const { return find(key) != cend(); }
+
+  /**
+   *@brief find function.
+   *@param key: key to be searched.
+   *@returns const_iterator: an iterator to the stored element, cend() if the
+   *key does not exist.
+   */
+  const_iterator find(const key_type &key) const {
+    const_iterator it(this);
+    return _descend(it, key) ? it : cend();
+  }
+
+  /**
+   *@brief hinted find function, the search starts from hint and climbs only
+   *as far as needed.
+   *@param hint: an iterator of this tree, ignored if the tree changed since it
+   *was obtained.
+   *@param key: key to be searched.
+   *@returns const_iterator: an iterator to the stored element, cend() if the
+   *key does not exist.
+   */
+  const_iterator find(const const_iterator &hint, const key_type &key) const {
+    const_iterator it = _finger(hint, key);
+    return _descend(it, key) ? it : cend();
+  }
+
+  /**
+   *@brief find_unshared function, a find for elements whose mutable members
+   *are about to change. The path to the element is copied where a copy of
+   *this tree still shares it, in the same descent.
+   *@param key: key to be searched.
+   *@returns const_iterator: an iterator to the element, cend() if the key
+   *does not exist.
+   */
+  const_iterator find_unshared(const key_type &key) {
+    trail it;
+    if (!_descend(it, key)) {
+      return cend();
+    }
+    _own_path(it);
+    return const_iterator(this, it);
+  }
+
+  /**
+   *@brief lower_bound function.
+   *@returns const_iterator: the first element that is not less than key.
+   */
+  const_iterator lower_bound(const key_type &key) const {
+    return _bound(key, [](auto c) { return c <= 0; });
+  }
+
+  /**
+   *@brief upper_bound function.
+   *@returns const_iterator: the first element that is greater than key.
+   */
+  const_iterator upper_bound(const key_type &key) const {
+    return _bound(key, [](auto c) { return c < 0; });
+  }
+
+  /**
+   *@brief rank function, every node keeps the size of its subtree so this is
+   *a single descent.
+   *@param key: key to be ranked, it does not have to exist.
+   *@returns size_t: the number of keys smaller than key.
+   */
+  size_t rank(const key_type &key) const {
+    size_t r = 0;
+    const node *curr = root.get();
+    while (curr) {
+      auto c = _compare(key, _proj(curr->info));
+      if (c == 0) {
+        return r + count(curr->left);
+      }
+      if (c < 0) {
+        curr = curr->left.get();
+      } else {
+        r += count(curr->left) + 1;
+        curr = curr->right.get();
+      }
+    }
+    return r;
+  }
+
+  /**
+   *@brief select function.
+   *@param k: zero based position in sorted order.
+   *@returns const_iterator: an iterator to the k-th smallest key, or cend()
+   *if k >= size().
+   */
+  const_iterator select(size_t k) const {
+    const_iterator it(this);
+    if (k >= _size) {
+      return it;
+    }
+    const node *curr = root.get();
+    while (true) {
+      it.push(curr);
+      size_t left = count(curr->left);
+      if (k == left) {
+        return it;
+      }
+      if (k < left) {
+        curr = curr->left.get();
+      } else {
+        k -= left + 1;
+        curr = curr->right.get();
+      }
+    }
+  }
+
+  /**
+   *@brief aggregate function, folds the aggregates of every key of the tree.
+   */
+  aggregate_type aggregate() const
+    requires has_aggregate
+  {
+    return total(root);
+  }
+
+  /**
+   *@brief aggregate function, folds the aggregates of the keys in
+   *[first, last) in O(log n).
+   *@param first: the smallest key of the range.
+   *@param last: the end of the range, it is not included.
+   */
+  aggregate_type aggregate(const key_type &first, const key_type &last) const
+    requires has_aggregate
+  {
+    return _fold(root.get(), &first, &last);
+  }
+
+  /**
+   *@brief aggregate_below function, folds the aggregates of the keys smaller
+   *than key.
+   */
+  aggregate_type aggregate_below(const key_type &key) const
+    requires has_aggregate
+  {
+    return _fold(root.get(), nullptr, &key);
+  }
+
+  /**
+   *@brief aggregate_from function, folds the aggregates of the keys that are
+   *not smaller than key.
+   */
+  aggregate_type aggregate_from(const key_type &key) const
+    requires has_aggregate
+  {
+    return _fold(root.get(), &key, nullptr);
+  }
+
+  /**
+   *@brief cbegin function.
+   *@returns const_iterator: an iterator to the smallest element.
+   */
+  const_iterator cbegin() const {
+    const_iterator it(this);
+    it.push_leftmost(root.get());
+    return it;
+  }
+
+  /**
+   *@brief cend function.
+   *@returns const_iterator: the past the end iterator.
+   */
+  const_iterator cend() const { return const_iterator(this); }
+
+  /**
+   *@brief predecessor function.
+   *@returns const T*: the last element that is less than key or nullptr.
+   */
+  const T *predecessor(const key_type &key) const {
+    const node *curr = root.get();
+    const T *best = nullptr;
+    while (curr) {
+      if (_compare(key, _proj(curr->info)) > 0) {
+        best = &curr->info;
+        curr = curr->right.get();
+      } else {
+        curr = curr->left.get();
+      }
+    }
+    return best;
+  }
+
+  /**
+   *@brief first function.
+   *@returns const T*: the smallest element or nullptr if the tree is empty.
+   */
+  const T *first() const {
+    const node *curr = root.get();
+    while (curr && curr->left) {
+      curr = curr->left.get();
+    }
+    return curr ? &curr->info : nullptr;
+  }
+
+  /**
+   *@brief last function.
+   *@returns const T*: the biggest element or nullptr if the tree is empty.
+   */
+  const T *last() const {
+    const node *curr = root.get();
+    while (curr && curr->right) {
+      curr = curr->right.get();
+    }
+    return curr ? &curr->info : nullptr;
+  }
 
   class Iterator;
 
@@ -117,10 +708,126 @@ public:
   /**
    *@brief remove function.
    *@param key: key to be removed.
+   *@returns true if the key existed in the tree.
+   */
+  bool remove(const key_type &key) {
+    node_ptr removed;
+    root = _remove(std::move(root), key, removed);
+    if (!removed) {
+      return false;
+    }
+    _size--;
+    _version++;
+    return true;
+  }
+
+  /**
+   *@brief pop_min function, unlinks the smallest node by walking the left
+   *spine, no key is compared.
+   *@returns T: the removed key, the tree must not be empty.
+   */
+  T pop_min() { return _pop_end(true); }
+
+  /**
+   *@brief pop_max function, unlinks the biggest node by walking the right
+   *spine.
+   *@returns T: the removed key, the tree must not be empty.
    */
-  void remove(T key) {
-    root = _remove(root, key);
+  T pop_max() { return _pop_end(false); }
+
+  /**
+   *@brief extract_min function, unlinks the smallest node and hands it over
+   *instead of freeing it.
+   *@returns node_handle: the node, the tree must not be empty.
+   */
+  node_handle extract_min() { return node_handle(_unlink_end(true)); }
+
+  /**
+   *@brief extract_max function, unlinks the biggest node and hands it over.
+   *@returns node_handle: the node, the tree must not be empty.
+   */
+  node_handle extract_max() { return node_handle(_unlink_end(false)); }
+
+  /**
+   *@brief extract function, unlinks the node that holds key and hands it
+   *over instead of freeing it. It takes the same single descent as remove.
+   *@param key: key to be extracted.
+   *@returns node_handle: the node, or an empty handle if key does not exist.
+   */
+  node_handle extract(const key_type &key) {
+    node_ptr removed;
+    root = _remove(std::move(root), key, removed);
+    if (!removed) {
+      return node_handle();
+    }
     _size--;
+    _version++;
+    return node_handle(_detach(std::move(removed)));
+  }
+
+  /**
+   *@brief insert function for a node_handle, links the node itself so no
+   *allocation takes place.
+   *@param nh: the node to be inserted, it is left empty if it was inserted.
+   *@returns insert_return_type: the position of the key, whether the node
+   *was inserted and the node back if the key already existed.
+   */
+  insert_return_type insert(node_handle &&nh) {
+    if (nh.empty()) {
+      return {cend(), false, node_handle()};
+    }
+    const key_type &key = _proj(nh.value());
+    auto adopt = [&]() { return std::move(nh._node); };
+    auto [it, inserted] = _insert_at(trail(), key, adopt, false);
+    return {it, inserted, std::move(nh)};
+  }
+
+  /**
+   *@brief erase function, removes every key in [first, last) by splitting
+   *the tree at both ends and joining the outer parts in O(log n), plus the
+   *cost of freeing the removed nodes.
+   *@returns size_t: the number of removed keys.
+   */
+  size_t erase(const key_type &first, const key_type &last) {
+    return _erase_range(&first, &last);
+  }
+
+  /**
+   *@brief erase_below function, removes every key smaller than key.
+   *@returns size_t: the number of removed keys.
+   */
+  size_t erase_below(const key_type &key) { return _erase_range(nullptr, &key); }
+
+  /**
+   *@brief erase_from function, removes every key that is not smaller than key.
+   *@returns size_t: the number of removed keys.
+   */
+  size_t erase_from(const key_type &key) { return _erase_range(&key, nullptr); }
+
+  /**
+   *@brief erase_if function, removes every element that satisfies pred. The
+   *surviving nodes are relinked into a balanced tree in O(n), so nothing is
+   *allocated and no key is compared.
+   *@returns size_t: the number of removed keys.
+   */
+  template <typename Pred> size_t erase_if(Pred pred) {
+    std::vector<node_ptr> kept;
+    kept.reserve(_size);
+    // a node below a shared one is shared as well, those are copied
+    auto keep = [&](const node_ptr &n, bool shared) {
+      if (!std::invoke(pred, std::as_const(n->info))) {
+        kept.push_back(shared ? node_ptr::make(*n) : n);
+      }
+    };
+    _each_node(root, keep, false);
+    size_t removed = _size - kept.size();
+    if (removed == 0) {
+      return 0;
+    }
+    root = _build(kept, 0, kept.size());
+    _size = kept.size();
+    _version++;
+    return removed;
   }
 
   /**
@@ -130,7 +837,7 @@ public:
   std::vector<T> inorder() const {
     std::vector<T> path;
     _inorder(
-      [&](std::shared_ptr<node> callbacked) {
+      [&](node_ptr callbacked) {
         path.push_back(callbacked->info);
       },
       root);
@@ -143,7 +850,7 @@ public:
   std::vector<T> preorder() const {
     std::vector<T> path;
     _preorder(
-      [&](std::shared_ptr<node> callbacked) {
+      [&](node_ptr callbacked) {
         path.push_back(callbacked->info);
       },
       root);
@@ -156,7 +863,7 @@ public:
   std::vector<T> postorder() const {
     std::vector<T> path;
     _postorder(
-      [&](std::shared_ptr<node> callbacked) {
+      [&](node_ptr callbacked) {
         path.push_back(callbacked->info);
       },
       root);
@@ -169,13 +876,13 @@ public:
    */
   std::vector<std::vector<T>> level_order() {
     std::vector<std::vector<T>> path;
-    std::queue<std::shared_ptr<node>> q;
+    std::queue<node_ptr> q;
     q.push(root);
     while (!q.empty()) {
       size_t size = q.size();
       std::vector<T> level;
       for (size_t i = 0; i < size; i++) {
-        std::shared_ptr<node> current = q.front();
+        node_ptr current = q.front();
         q.pop();
         level.push_back(current->info);
         if (current->left) {
@@ -193,7 +900,7 @@ public:
   /**
    * @brief operator << for avl_tree class
    */
-  friend std::ostream & operator << (std::ostream &out, avl_tree<T> &t){
+  friend std::ostream & operator << (std::ostream &out, avl_tree &t){
     std::vector<std::vector<T> > order = t.inorder();
     for(int i = 0; i<order.size(); i++){
       if(i != order.size() - 1){
@@ -207,127 +914,720 @@ public:
   }
 
 private:
+  struct node;
+  using node_ptr = bubble_detail::counted_ptr<node>;
+
   /**
    *@brief Struct for the node type pointer.
    *@param info: the value of the node.
    *@param height: height of each node.
    *@param left: pointer to the left.
    *@param right: pointer to the right.
+   *@param refs: the number of node_ptrs that own the node.
    */
   typedef struct node {
     T info;
-    int64_t height{0};
-    std::shared_ptr<node> left;
-    std::shared_ptr<node> right;
-    node(T key) : info(key), left(nullptr), right(nullptr) {}
+    int64_t height{1};
+    size_t count{1};
+    [[no_unique_address]] aggregate_type total{};
+    node_ptr left;
+    node_ptr right;
+    std::atomic<size_t> refs{0};
+    node(T key) : info(std::move(key)), left(nullptr), right(nullptr) {}
+    // a copy starts without owners, like a node that was just allocated
+    node(const node &n)
+        : info(n.info), height(n.height), count(n.count), total(n.total),
+          left(n.left), right(n.right) {}
   } node;
 
-  std::shared_ptr<node> root;
-  size_t _size{};
+  /**
+   *@brief an avl tree with 64 levels holds more than 2^44 nodes
+   */
+  static constexpr size_t max_depth = 64;
 
-  int64_t height(std::shared_ptr<node> root) {
-    if (root == nullptr)
-      return 0;
-    return 1 + std::max(height(root->left), height(root->right));
-  }
+  /**
+   *@brief every node on the way from the root down to one node. The write
+   *paths work on a trail, a const_iterator keeps only the turns of it and its
+   *deepest nodes and is expanded into a trail again when it is used as a hint.
+   */
+  struct trail {
+    size_t depth{0};
+    const node *path[max_depth];
 
-  std::shared_ptr<node> createNode(T info) {
-    std::shared_ptr<node> nn = std::make_shared<node>(info);
-    return nn;
-  }
+    trail() noexcept {}
 
-  int64_t getBalance(std::shared_ptr<node> root) {
-    return height(root->left) - height(root->right);
-  }
+    void push(const node *n) {
+      assert(depth < max_depth);
+      path[depth++] = n;
+    }
 
-  std::shared_ptr<node> rightRotate(std::shared_ptr<node> root) {
-    std::shared_ptr<node> t = root->left;
-    std::shared_ptr<node> u = t->right;
-    t->right = root;
-    root->left = u;
+    const node *top() const { return path[depth - 1]; }
+
+    void push_leftmost(const node *n) {
+      for (; n; n = n->left.get()) {
+        push(n);
+      }
+    }
+
+    void push_rightmost(const node *n) {
+      for (; n; n = n->right.get()) {
+        push(n);
+      }
+    }
+  };
+
+  node_ptr root;
+  size_t _size{};
+  uint64_t _version{0};
+  [[no_unique_address]] Compare _comp{};
+
+  static decltype(auto) _proj(const T &x) {
+    return std::invoke(Projection, x);
+  }
+
+  auto _compare(const key_type &a, const key_type &b) const {
+    return bubble_detail::three_way(_comp, a, b);
+  }
+
+  static int64_t height(const node_ptr &root) {
+    return root ? root->height : 0;
+  }
+
+  static size_t count(const node_ptr &root) {
+    return root ? root->count : 0;
+  }
+
+  static aggregate_type total(const node_ptr &root) {
+    return root ? root->total : Aggregate::identity();
+  }
+
+  static void update_total(node *root) {
+    root->total = Aggregate::combine(
+        Aggregate::combine(total(root->left), Aggregate::lift(root->info)),
+        total(root->right));
+  }
+
+  static void update(const node_ptr &root) {
+    root->height = 1 + std::max(height(root->left), height(root->right));
+    root->count = 1 + count(root->left) + count(root->right);
+    if constexpr (has_aggregate) {
+      update_total(root.get());
+    }
+  }
+
+  node_ptr createNode(T info) {
+    node_ptr nn = node_ptr::make(std::move(info));
+    if constexpr (has_aggregate) {
+      update_total(nn.get());
+    }
+    return nn;
+  }
+
+  static int64_t getBalance(const node_ptr &root) {
+    return height(root->left) - height(root->right);
+  }
+
+  node_ptr rightRotate(node_ptr root) {
+    _own(root->left);
+    node_ptr t = root->left;
+    node_ptr u = t->right;
+    t->right = root;
+    root->left = u;
+    update(root);
+    update(t);
     return t;
   }
 
-  std::shared_ptr<node> leftRotate(std::shared_ptr<node> root) {
-    std::shared_ptr<node> t = root->right;
-    std::shared_ptr<node> u = t->left;
+  node_ptr leftRotate(node_ptr root) {
+    _own(root->right);
+    node_ptr t = root->right;
+    node_ptr u = t->left;
     t->left = root;
     root->right = u;
+    update(root);
+    update(t);
     return t;
   }
 
-  std::shared_ptr<node> minValue(std::shared_ptr<node> root) {
+  node_ptr rebalance(node_ptr root) {
+    update(root);
+    int64_t b = getBalance(root);
+    if (b > 1) {
+      if (getBalance(root->left) < 0) {
+        _own(root->left);
+        root->left = leftRotate(root->left);
+      }
+      return rightRotate(root);
+    } else if (b < -1) {
+      if (getBalance(root->right) > 0) {
+        _own(root->right);
+        root->right = rightRotate(root->right);
+      }
+      return leftRotate(root);
+    }
+    return root;
+  }
+
+  /**
+   *@brief joins l, k and r, where every key of l is smaller than k and every
+   *key of r is bigger. The taller tree is descended along its inner spine to
+   *the first subtree that is at most one level taller than the other one, k
+   *is linked there and the spine is rebalanced on the way back up.
+   */
+  node_ptr _join(node_ptr l, node_ptr k,
+                              node_ptr r) {
+    if (height(l) > height(r) + 1) {
+      _own(l);
+      l->right = _join(std::move(l->right), std::move(k), std::move(r));
+      return rebalance(std::move(l));
+    }
+    if (height(r) > height(l) + 1) {
+      _own(r);
+      r->left = _join(std::move(l), std::move(k), std::move(r->left));
+      return rebalance(std::move(r));
+    }
+    _own(k);
+    k->left = std::move(l);
+    k->right = std::move(r);
+    update(k);
+    return k;
+  }
+
+  /**
+   *@brief joins l and r, where every key of l is smaller than every key of
+   *r, by taking the smallest node of r as the middle key.
+   */
+  node_ptr _join(node_ptr l, node_ptr r) {
+    if (!l) {
+      return r;
+    }
+    if (!r) {
+      return l;
+    }
+    node_ptr k;
+    r = _remove_min(std::move(r), k);
+    return _join(std::move(l), std::move(k), std::move(r));
+  }
+
+  /**
+   *@brief splits root into the keys smaller than key and the rest, every
+   *level joins the detached side subtree back in, so the whole split costs
+   *O(log n).
+   */
+  std::pair<node_ptr, node_ptr>
+  _split(node_ptr root, const key_type &key) {
+    if (!root) {
+      return {nullptr, nullptr};
+    }
+    _own(root);
+    node_ptr left = std::move(root->left);
+    node_ptr right = std::move(root->right);
+    if (_compare(_proj(root->info), key) < 0) {
+      auto [smaller, rest] = _split(std::move(right), key);
+      return {_join(std::move(left), std::move(root), std::move(smaller)),
+              std::move(rest)};
+    }
+    auto [smaller, rest] = _split(std::move(left), key);
+    return {std::move(smaller),
+            _join(std::move(rest), std::move(root), std::move(right))};
+  }
+
+  size_t _erase_range(const key_type *lo, const key_type *hi) {
+    if (!root || (lo && hi && _compare(*lo, *hi) >= 0)) {
+      return 0;
+    }
+    node_ptr left, right;
+    node_ptr rest = std::move(root);
+    if (lo) {
+      std::tie(left, rest) = _split(std::move(rest), *lo);
+    }
+    if (hi) {
+      std::tie(rest, right) = _split(std::move(rest), *hi);
+    }
+    size_t removed = count(rest);
+    root = _join(std::move(left), std::move(right));
+    _size -= removed;
+    if (removed > 0) {
+      _version++;
+    }
+    return removed;
+  }
+
+  /**
+   *@brief visits the nodes of root in order, together with whether the node
+   *is reachable from outside this tree.
+   */
+  template <typename F>
+  static void _each_node(const node_ptr &root, F &visit,
+                         bool shared) {
+    if (root) {
+      shared = shared || root.use_count() > 1;
+      _each_node(root->left, visit, shared);
+      visit(root, shared);
+      _each_node(root->right, visit, shared);
+    }
+  }
+
+  /**
+   *@brief links nodes[first, last), which are sorted, into a balanced tree.
+   */
+  static node_ptr _build(std::vector<node_ptr> &nodes,
+                                      size_t first, size_t last) {
+    if (first == last) {
+      return nullptr;
+    }
+    size_t mid = first + (last - first) / 2;
+    node_ptr root = std::move(nodes[mid]);
+    root->left = _build(nodes, first, mid);
+    root->right = _build(nodes, mid + 1, last);
+    update(root);
+    return root;
+  }
+
+  node_ptr minValue(node_ptr root) const {
     if (root->left == nullptr)
       return root;
     return minValue(root->left);
   }
 
-  std::shared_ptr<node> _insert(std::shared_ptr<node> root, T item) {
-    std::shared_ptr<node> nn = createNode(item);
-    if (root == nullptr)
-      return nn;
-    if (item < root->info) {
-      root->left = _insert(root->left, item);
+  /**
+   *@brief unlinks the smallest node of root's subtree.
+   *@param min: receives the unlinked node.
+   *@returns the new root of the subtree.
+   */
+  node_ptr _remove_min(node_ptr root,
+                                    node_ptr &min) {
+    _own(root);
+    if (root->left == nullptr) {
+      min = root;
+      return std::move(root->right);
     }
-    else if (item > root->info) {
-      root->right = _insert(root->right, item);
+    root->left = _remove_min(std::move(root->left), min);
+    return rebalance(std::move(root));
+  }
+
+  /**
+   *@brief makes the node behind p private to p. A node that another tree,
+   *snapshot or node_handle still references is copied, its children stay
+   *shared until a write reaches them. The count is read with acquire order,
+   *so when another thread just dropped the last other reference, its reads
+   *of the node happen before the writes that follow.
+   */
+  static void _own(node_ptr &p) {
+    if (p && p.use_count() > 1) {
+      p = node_ptr::make(*p);
+    }
+  }
+
+  /**
+   *@brief owns every node on the path of it from the root down, the copy of
+   *a shared parent shares its children, so they are copied in turn.
+   */
+  void _own_path(trail &it) {
+    for (size_t i = 0; i < it.depth; i++) {
+      node_ptr &slot = _slot(it, i);
+      _own(slot);
+      it.path[i] = slot.get();
     }
-    else {
+  }
+
+  /**
+   *@brief the link that owns path[i] of it, either root or a child pointer of
+   *path[i - 1].
+   */
+  node_ptr &_slot(const trail &it, size_t i) {
+    if (i == 0) {
       return root;
     }
-    int b = getBalance(root);
-    if (b > 1) {
-      if (getBalance(root->left) < 0)
-        root->left = leftRotate(root->left);
-      return rightRotate(root);
-    } else if (b < -1) {
-      if (getBalance(root->right) > 0)
-        root->right = rightRotate(root->right);
-      return leftRotate(root);
+    node *parent = const_cast<node *>(it.path[i - 1]);
+    return parent->left.get() == it.path[i] ? parent->left : parent->right;
+  }
+
+  /**
+   *@brief unlinks the smallest or biggest node by walking one spine, no key
+   *is compared.
+   *@returns the unlinked node with its links cleared.
+   */
+  node_ptr _unlink_end(bool smallest) {
+    assert(root);
+    trail it;
+    if (smallest) {
+      it.push_leftmost(root.get());
+    } else {
+      it.push_rightmost(root.get());
     }
-    return root;
+    return _unlink(it);
   }
 
-  std::shared_ptr<node> _remove(std::shared_ptr<node> root, T key) {
-    if (root == nullptr)
-      return root;
-    if (key < root->info)
-      root->left = _remove(root->left, key);
-    else if (key > root->info)
-      root->right = _remove(root->right, key);
-
-    else {
-      if (!root->right) {
-        std::shared_ptr<node> temp = root->left;
-        root = nullptr;
-        return temp;
-      } else if (!root->left) {
-        std::shared_ptr<node> temp = root->right;
-        root = nullptr;
-        return temp;
-      }
-      std::shared_ptr<node> temp = minValue(root->right);
-      root->info = temp->info;
-      root->right = _remove(root->right, temp->info);
+  /**
+   *@brief unlinks the node it points to. A node with two children is
+   *replaced by its successor node, not by a copy of the successor's key, so
+   *every other node stays where it is.
+   *@returns the unlinked node with its links cleared.
+   */
+  node_ptr _unlink(trail &it) {
+    size_t at = it.depth - 1;
+    size_t bottom = at;
+    node_ptr victim;
+    if (it.top()->left && it.top()->right) {
+      it.push_leftmost(it.top()->right.get());
     }
-    return root;
+    _own_path(it);
+    if (it.depth - 1 > at) {
+      bottom = it.depth - 1;
+      node_ptr &successor_slot = _slot(it, bottom);
+      node_ptr successor = std::move(successor_slot);
+      successor_slot = std::move(successor->right);
+      node_ptr &slot = _slot(it, at);
+      victim = std::move(slot);
+      successor->left = std::move(victim->left);
+      successor->right = std::move(victim->right);
+      it.path[at] = successor.get();
+      slot = std::move(successor);
+    } else {
+      node_ptr &slot = _slot(it, at);
+      victim = std::move(slot);
+      slot = victim->left ? victim->left : victim->right;
+    }
+    // every ancestor lost a descendant. Once a subtree keeps its height the
+    // ones above it cannot rotate, they only drop one from their count, so
+    // the siblings along the rest of the path are never read
+    bool settled = false;
+    for (size_t i = bottom; i-- > 0;) {
+      node_ptr &ancestor = _slot(it, i);
+      if (settled && i != at) {
+        ancestor->count--;
+        if constexpr (has_aggregate) {
+          update_total(ancestor.get());
+        }
+        continue;
+      }
+      // the successor that took the victim's place inherits its height
+      int64_t old_height = i == at && bottom > at ? victim->height : ancestor->height;
+      ancestor = rebalance(ancestor);
+      settled = ancestor->height == old_height;
+    }
+    _size--;
+    _version++;
+    return _detach(std::move(victim));
   }
 
-  bool _search(std::shared_ptr<node> root, T key) {
-    while (root) {
-      if (root->info < key) {
-        root = root->right;
-      } else if (root->info > key) {
-        root = root->left;
-      } else {
+  /**
+   *@brief turns a node that was just unlinked into a single node tree. A
+   *copied tree can still share the node, a copy is handed out then.
+   */
+  node_ptr _detach(node_ptr victim) {
+    if (victim.use_count() > 1) {
+      return createNode(victim->info);
+    }
+    victim->left = nullptr;
+    victim->right = nullptr;
+    victim->height = 1;
+    victim->count = 1;
+    return victim;
+  }
+
+  T _pop_end(bool smallest) { return std::move(_unlink_end(smallest)->info); }
+
+  /**
+   *@brief the node that make() provides, either a new one around the T it
+   *returns or a recycled one from a node_handle.
+   */
+  template <typename F> node_ptr _make_node(F &make) {
+    if constexpr (std::same_as<std::invoke_result_t<F &>,
+                               node_ptr>) {
+      node_ptr n = make();
+      if constexpr (has_aggregate) {
+        update_total(n.get());
+      }
+      return n;
+    } else {
+      return createNode(make());
+    }
+  }
+
+  /**
+   *@brief cuts the path of hint down to the deepest node whose subtree can
+   *hold key. Only the ancestors that bound the climbed subtrees are compared
+   *against key, so a key next to the hint is found with O(log d) comparisons.
+   *Ancestors above the nodes hint keeps are found again by following its
+   *turns from the root, which compares nothing.
+   *@returns const_iterator: the shortened path, or an empty one if hint does
+   *not belong to the current version of this tree.
+   */
+  const_iterator _finger(const const_iterator &hint,
+                         const key_type &key) const {
+    if (hint.tree != this || hint.version != _version || hint.depth == 0) {
+      return const_iterator(this);
+    }
+    const_iterator it(hint);
+    trail above;
+    auto node_at = [&](size_t i) {
+      if (i >= hint.low) {
+        return hint.recent[i % const_iterator::window];
+      }
+      if (above.depth == 0) {
+        above = hint.expand();
+      }
+      return above.path[i];
+    };
+    constexpr size_t none = max_depth;
+    // lo[i] / hi[i]: the deepest ancestor of path[i] that holds it in its right
+    // / left subtree, i.e. the node that bounds path[i]'s keys from below / above
+    size_t lo[max_depth], hi[max_depth];
+    int8_t side[max_depth] = {};
+    lo[0] = hi[0] = none;
+    for (size_t i = 1; i < it.depth; i++) {
+      bool right = hint.turned_right(i - 1);
+      lo[i] = right ? i - 1 : lo[i - 1];
+      hi[i] = right ? hi[i - 1] : i - 1;
+    }
+    auto compare_with = [&](size_t i) {
+      if (side[i] == 0) {
+        auto c = _compare(key, _proj(node_at(i)->info));
+        side[i] = c < 0 ? -1 : (c > 0 ? 1 : 2);
+      }
+      return side[i];
+    };
+    size_t s = it.depth - 1;
+    while (s > 0 && !((lo[s] == none || compare_with(lo[s]) == 1) &&
+                      (hi[s] == none || compare_with(hi[s]) == -1))) {
+      s--;
+    }
+    it.pop_to(s + 1);
+    return it;
+  }
+
+  /**
+   *@brief finishes a search that starts at the bottom of it's path, or at the
+   *root if the path is empty. Path is a trail or a const_iterator.
+   *@returns true: if key was found, it is then at the bottom of the path.
+   */
+  template <typename Path>
+  bool _descend(Path &it, const key_type &key) const {
+    if (it.depth == 0 && root) {
+      it.push(root.get());
+    }
+    while (it.depth > 0) {
+      const node *curr = it.top();
+      auto c = _compare(key, _proj(curr->info));
+      if (c == 0) {
         return true;
       }
+      const node *child = c < 0 ? curr->left.get() : curr->right.get();
+      if (!child) {
+        return false;
+      }
+      it.push(child);
     }
     return false;
   }
 
-  void _inorder(std::function<void(std::shared_ptr<node>)> callback,
-                std::shared_ptr<node> root) const {
+  /**
+   *@brief descends towards key and keeps the path to the last node where
+   *goes_left held for the comparison of key against it.
+   */
+  template <typename Pred>
+  const_iterator _bound(const key_type &key, Pred goes_left) const {
+    const_iterator it(this);
+    size_t best = 0;
+    const node *curr = root.get();
+    while (curr) {
+      it.push(curr);
+      if (goes_left(_compare(key, _proj(curr->info)))) {
+        best = it.depth;
+        curr = curr->left.get();
+      } else {
+        curr = curr->right.get();
+      }
+    }
+    it.pop_to(best);
+    return it;
+  }
+
+  /**
+   *@brief iterative insertion that starts from the bottom of it's path, a
+   *trail or a const_iterator. The new node is linked in and the path is
+   *retraced upwards, rebalancing until a subtree keeps its old height.
+   *@param unshare: whether an element that already exists is copied out of
+   *the nodes this tree shares, for callers that change it.
+   *@returns std::pair<const_iterator, bool>: the path to the element with key
+   *and true if it was created.
+   */
+  template <typename Path, typename F>
+  std::pair<const_iterator, bool> _insert_at(Path it, const key_type &key,
+                                             F &make, bool unshare) {
+    if (!root) {
+      root = _make_node(make);
+      _size++;
+      _version++;
+      const_iterator first(this);
+      first.push(root.get());
+      return {first, true};
+    }
+    if (it.depth == 0) {
+      it.push(root.get());
+    }
+    while (true) {
+      const node *curr = it.top();
+      auto c = _compare(key, _proj(curr->info));
+      if (c == 0) {
+        if (!unshare) {
+          return {_iterator(it), false};
+        }
+        auto &&path = _full(it);
+        _own_path(path);
+        return {const_iterator(this, path), false};
+      }
+      const node_ptr &next = c < 0 ? curr->left : curr->right;
+      if (next) {
+        it.push(next.get());
+        continue;
+      }
+      auto &&path = _full(it);
+      _own_path(path);
+      node *parent = const_cast<node *>(path.top());
+      node_ptr &child = c < 0 ? parent->left : parent->right;
+      child = _make_node(make);
+      path.push(child.get());
+      _count_path(path);
+      // make() may have moved key into the new node, retrace with its copy
+      _retrace(path, _proj(path.top()->info));
+      _aggregate_path(path);
+      _size++;
+      _version++;
+      return {const_iterator(this, path), true};
+    }
+  }
+
+  /**
+   *@brief the whole path of it, which a hint only keeps in part. The write
+   *paths need every node of it.
+   */
+  static trail &_full(trail &it) { return it; }
+
+  static trail _full(const const_iterator &it) { return it.expand(); }
+
+  const_iterator _iterator(const trail &it) const {
+    return const_iterator(this, it);
+  }
+
+  static const_iterator _iterator(const const_iterator &it) { return it; }
+
+  /**
+   *@brief counts a new leaf at the bottom of it in the subtree sizes of its
+   *ancestors. _retrace can stop below the root, so this runs first.
+   */
+  static void _count_path(const trail &it) {
+    for (size_t i = 0; i + 1 < it.depth; i++) {
+      const_cast<node *>(it.path[i])->count++;
+    }
+  }
+
+  /**
+   *@brief recomputes the aggregates along it bottom-up after an insertion.
+   *It runs after _retrace, whose rotations already refreshed the nodes they
+   *moved, so recomputing those again is harmless.
+   */
+  static void _aggregate_path(const trail &it) {
+    if constexpr (has_aggregate) {
+      for (size_t i = it.depth; i-- > 0;) {
+        update_total(const_cast<node *>(it.path[i]));
+      }
+    }
+  }
+
+  /**
+   *@brief folds the aggregates of the keys in [lo, hi) under root, a null
+   *bound is open. Once the bounds split, every subtree hanging off the two
+   *boundary paths is taken whole, so this is O(log n).
+   */
+  aggregate_type _fold(const node *root, const key_type *lo,
+                       const key_type *hi) const {
+    while (root) {
+      if (!lo && !hi) {
+        return root->total;
+      }
+      const key_type &key = _proj(root->info);
+      if (lo && _compare(key, *lo) < 0) {
+        root = root->right.get();
+      } else if (hi && _compare(key, *hi) >= 0) {
+        root = root->left.get();
+      } else {
+        return Aggregate::combine(
+            Aggregate::combine(_fold(root->left.get(), lo, nullptr),
+                               Aggregate::lift(root->info)),
+            _fold(root->right.get(), nullptr, hi));
+      }
+    }
+    return Aggregate::identity();
+  }
+
+  void _retrace(trail &it, const key_type &key) {
+    for (size_t i = it.depth - 1; i-- > 0;) {
+      node *curr = const_cast<node *>(it.path[i]);
+      int64_t old_height = curr->height;
+      node_ptr &slot = _slot(it, i);
+      node_ptr balanced = rebalance(slot);
+      if (balanced.get() != curr) {
+        slot = balanced;
+        // the rotation reshaped the subtree below path[i], walk down to key
+        // again. An insertion rotates once and the subtree gets back its old
+        // height, so nothing above changes
+        it.depth = i;
+        const node *below = balanced.get();
+        while (below) {
+          it.push(below);
+          auto c = _compare(key, _proj(below->info));
+          if (c == 0) {
+            break;
+          }
+          below = c < 0 ? below->left.get() : below->right.get();
+        }
+        return;
+      }
+      if (curr->height == old_height) {
+        return;
+      }
+    }
+  }
+
+  /**
+   *@brief unlinks the node that holds key from root's subtree in a single
+   *descent.
+   *@param removed: receives the unlinked node, it still holds its old links.
+   *@returns the new root of the subtree.
+   */
+  node_ptr _remove(node_ptr root, const key_type &key, node_ptr &removed) {
+    if (root == nullptr)
+      return root;
+    auto c = _compare(key, _proj(root->info));
+    if (c == 0) {
+      if (!root->right || !root->left) {
+        node_ptr child = root->left ? root->left : root->right;
+        removed = std::move(root);
+        return child;
+      }
+      // relink the successor in place of root instead of copying its info
+      _own(root);
+      node_ptr successor;
+      node_ptr right = _remove_min(std::move(root->right), successor);
+      successor->left = std::move(root->left);
+      successor->right = std::move(right);
+      removed = std::move(root);
+      return rebalance(std::move(successor));
+    }
+    _own(root);
+    node_ptr &child = c < 0 ? root->left : root->right;
+    child = _remove(std::move(child), key, removed);
+    if (!removed) {
+      return root;
+    }
+    return rebalance(std::move(root));
+  }
+
+  void _inorder(std::function<void(node_ptr)> callback,
+                node_ptr root) const {
     if (root) {
       _inorder(callback, root->left);
       callback(root);
@@ -335,8 +1635,8 @@ private:
     }
   }
 
-  void _postorder(std::function<void(std::shared_ptr<node>)> callback,
-                  std::shared_ptr<node> root) const {
+  void _postorder(std::function<void(node_ptr)> callback,
+                  node_ptr root) const {
     if (root) {
       _inorder(callback, root->left);
       _inorder(callback, root->right);
@@ -344,8 +1644,8 @@ private:
     }
   }
 
-  void _preorder(std::function<void(std::shared_ptr<node>)> callback,
-                 std::shared_ptr<node> root) const {
+  void _preorder(std::function<void(node_ptr)> callback,
+                 node_ptr root) const {
     if (root) {
       callback(root);
       _inorder(callback, root->left);
@@ -358,7 +1658,8 @@ private:
 /**
  * @brief Iterator class
  */
-template <typename T> class avl_tree<T>::Iterator {
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+class avl_tree<T, Compare, Projection, Aggregate>::Iterator {
 private:
   std::vector<T> elements;
   int64_t index;
@@ -438,7 +1739,8 @@ public:
    * @return false otherwise
    */
   bool operator!=(const Iterator &it) {
-    return index != it.index && elements[index] != it.elements[it.index];
+    // end() sits one past the last element, so only the index can be compared
+    return index != it.index;
   }
 
   /**
@@ -449,4 +1751,211 @@ public:
   T operator*() { return elements[index]; }
 };
 
+/**
+ * @brief const_iterator class, it keeps the turns from the root to the
+ * current node and the last few nodes of that path, so it can step in both
+ * directions and act as a finger for hinted operations without parent
+ * pointers. Any insertion or removal invalidates it.
+ */
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+class avl_tree<T, Compare, Projection, Aggregate>::const_iterator {
+private:
+  friend class avl_tree;
+
+  /**
+   * @brief how many of the deepest nodes on the path are kept. A climb past
+   * them walks the turns down from the root again, which in an in-order walk
+   * happens for about one step in 2^window
+   */
+  static constexpr size_t window = 8;
+
+  const avl_tree *tree{nullptr};
+  uint64_t version{0};
+  // bit i is set when the node on level i + 1 is the right child of the one
+  // on level i
+  uint64_t turns{0};
+  uint32_t depth{0};
+  // the nodes on the levels [low, depth), level i is kept in recent[i % window]
+  uint32_t low{0};
+  const node *recent[window]{};
+
+  explicit const_iterator(const avl_tree *tree) noexcept
+      : tree(tree), version(tree->_version) {}
+
+  const_iterator(const avl_tree *tree, const trail &t) noexcept
+      : tree(tree), version(tree->_version),
+        depth(static_cast<uint32_t>(t.depth)),
+        low(depth > window ? depth - window : 0) {
+    for (size_t i = 1; i < depth; i++) {
+      turns |= uint64_t{t.path[i - 1]->right.get() == t.path[i]} << (i - 1);
+    }
+    for (size_t i = low; i < depth; i++) {
+      recent[i % window] = t.path[i];
+    }
+  }
+
+  void push(const node *n) {
+    assert(depth < max_depth);
+    if (depth > 0) {
+      uint64_t bit = uint64_t{1} << (depth - 1);
+      turns = top()->right.get() == n ? turns | bit : turns & ~bit;
+    }
+    recent[depth % window] = n;
+    depth++;
+    if (depth - low > window) {
+      low = depth - window;
+    }
+  }
+
+  const node *top() const { return recent[(depth - 1) % window]; }
+
+  bool turned_right(size_t i) const { return (turns >> i) & 1; }
+
+  void push_leftmost(const node *n) {
+    for (; n; n = n->left.get()) {
+      push(n);
+    }
+  }
+
+  void push_rightmost(const node *n) {
+    for (; n; n = n->right.get()) {
+      push(n);
+    }
+  }
+
+  /**
+   * @brief climbs to level d - 1, its node is found again from the root if it
+   * fell out of the window
+   */
+  void pop_to(size_t d) {
+    depth = static_cast<uint32_t>(d);
+    if (depth == 0) {
+      low = 0;
+    } else if (depth - 1 < low) {
+      low = depth > window ? depth - window : 0;
+      const node *n = tree->root.get();
+      for (size_t i = 0; i < depth; i++) {
+        if (i >= low) {
+          recent[i % window] = n;
+        }
+        n = turned_right(i) ? n->right.get() : n->left.get();
+      }
+    }
+  }
+
+  /**
+   * @brief the whole path, every node is found again by following the turns
+   * from the root
+   */
+  trail expand() const {
+    trail t;
+    const node *n = tree->root.get();
+    for (size_t i = 0; i < depth; i++) {
+      t.push(n);
+      n = turned_right(i) ? n->right.get() : n->left.get();
+    }
+    return t;
+  }
+
+public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const T *;
+  using reference = const T &;
+
+  const_iterator() noexcept = default;
+
+  reference operator*() const { return top()->info; }
+
+  pointer operator->() const { return &top()->info; }
+
+  const_iterator &operator++() {
+    if (depth == 0) {
+      return *(this);
+    }
+    const node *curr = top();
+    if (curr->right) {
+      push_leftmost(curr->right.get());
+      return *(this);
+    }
+    // climb until we leave a left subtree, its parent is the successor
+    size_t d = depth - 1;
+    while (d > 0 && turned_right(d - 1)) {
+      d--;
+    }
+    pop_to(d);
+    return *(this);
+  }
+
+  const_iterator operator++(int) {
+    const_iterator it = *this;
+    ++*(this);
+    return it;
+  }
+
+  const_iterator &operator--() {
+    if (depth == 0) {
+      push_rightmost(tree->root.get());
+      return *(this);
+    }
+    const node *curr = top();
+    if (curr->left) {
+      push_rightmost(curr->left.get());
+      return *(this);
+    }
+    size_t d = depth - 1;
+    while (d > 0 && !turned_right(d - 1)) {
+      d--;
+    }
+    pop_to(d);
+    return *(this);
+  }
+
+  const_iterator operator--(int) {
+    const_iterator it = *this;
+    --*(this);
+    return it;
+  }
+
+  bool operator==(const const_iterator &it) const {
+    return (depth ? top() : nullptr) == (it.depth ? it.top() : nullptr);
+  }
+
+  bool operator!=(const const_iterator &it) const { return !(*this == it); }
+};
+
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+class avl_tree<T, Compare, Projection, Aggregate>::node_handle {
+private:
+  friend class avl_tree;
+  node_ptr _node;
+
+  explicit node_handle(node_ptr n) noexcept : _node(std::move(n)) {}
+
+public:
+  node_handle() noexcept = default;
+  node_handle(node_handle &&) noexcept = default;
+  node_handle &operator=(node_handle &&) noexcept = default;
+  node_handle(const node_handle &) = delete;
+  node_handle &operator=(const node_handle &) = delete;
+
+  bool empty() const noexcept { return _node == nullptr; }
+
+  explicit operator bool() const noexcept { return !empty(); }
+
+  /**
+   *@brief the stored key, changing it is allowed since the node is not part
+   *of any tree.
+   */
+  T &value() const { return _node->info; }
+};
+
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+struct avl_tree<T, Compare, Projection, Aggregate>::insert_return_type {
+  const_iterator position;
+  bool inserted;
+  node_handle node;
+};
+
 #endif
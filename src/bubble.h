@@ -17,93 +17,990 @@
 #include <algorithm>
 #include <utility>
 #include <cassert>
+#include <iterator>
+#include <bit>
+#include <concepts>
+#include <limits>
+#include <future>
+#include <thread>
 #include "avl_tree.h"
 #endif
 
 /**
-* @brief implementation of bubble<T, SIZE>
+* @brief implementation of bubble<T, SIZE, Compare, Projection>
+* @tparam Compare: strict weak ordering applied to the projected keys
+* @tparam Projection: callable or member pointer that maps a stored T to the key that is
+* compared, e.g. bubble<Order, 1024, std::less<>, &Order::id> only ever compares Order::id
+* @tparam Aggregate: policy whose value the trees keep per subtree and the bubble per bucket,
+* e.g. sum_min_max<double, &Order::amount>. See no_aggregate
 */
-template <typename T, size_t _SIZE>
+template <typename T, size_t _SIZE, typename Compare = std::less<>, auto Projection = std::identity{}, typename Aggregate = no_aggregate>
 class bubble {
+public:
+    using tree_type = avl_tree<T, Compare, Projection, Aggregate>;
+    using key_type = typename tree_type::key_type;
+    using aggregate_type = typename tree_type::aggregate_type;
+    static constexpr bool has_aggregate = tree_type::has_aggregate;
+
+    /**
+    * @brief iterator over every key of the bubble in sorted order
+    */
+    class const_iterator;
+
+    /**
+    * @brief owning handle of an extracted element, see extract and insert(node_type&&)
+    */
+    using node_type = typename tree_type::node_handle;
+
+    /**
+    * @brief result of insert(node_type&&), node is empty unless the key already existed
+    */
+    struct insert_return_type {
+        const_iterator position;
+        bool inserted;
+        node_type node;
+    };
+
 private:
-    std::vector<std::pair<T, std::optional<avl_tree<T>>>> list;
+    std::vector<std::pair<T, std::optional<tree_type>>> list;
     size_t _size;
+    uint64_t _version{0};
+    // Fenwick tree over the bucket sizes, the pivot plus its tree. Point updates keep it current
+    // while the pivot array stays the same, any other change drops it until the next query
+    mutable std::vector<size_t> _counts;
+    mutable bool _counts_valid{false};
+    // segment tree over the bucket totals of Aggregate with one leaf per pivot slot, kept the
+    // same way as _counts
+    mutable std::vector<aggregate_type> _totals;
+    mutable bool _totals_valid{false};
+
+    /**
+    * @brief cached pointer to the smallest or biggest key, null when unknown. A copy starts out
+    * empty since it would point into the bubble it was copied from
+    */
+    struct _extreme {
+        const T* key{nullptr};
+        _extreme() noexcept = default;
+        _extreme(const _extreme&) noexcept {}
+        _extreme& operator=(const _extreme&) noexcept {
+            key = nullptr;
+            return *this;
+        }
+    };
+    mutable _extreme _cached_min, _cached_max;
+
+    /**
+    * @brief set on both sides once a copy shares tree nodes with this bubble. A write may then
+    * copy the node a cached extreme points to, so the caches are dropped instead of kept
+    */
+    struct _sharing {
+        mutable bool on{false};
+        _sharing() noexcept = default;
+        _sharing(const _sharing& other) noexcept : on(true) { other.on = true; }
+        _sharing(_sharing&& other) noexcept : on(other.on) {}
+        _sharing& operator=(const _sharing& other) noexcept {
+            on = true;
+            other.on = true;
+            return *this;
+        }
+        _sharing& operator=(_sharing&& other) noexcept {
+            on = other.on;
+            return *this;
+        }
+    };
+    _sharing _shared;
+    [[no_unique_address]] Compare comp{};
+
+    static decltype(auto) _proj(const T& x) { return std::invoke(Projection, x); }
+
+    auto _compare(const key_type& a, const key_type& b) const { return bubble_detail::three_way(comp, a, b); }
+
+    /**
+    * @brief single pass binary search over the pivots, it does one three-way comparison per step
+    * and stops as soon as a pivot matches
+    * @param key: the key we are looking for
+    * @return std::pair<size_t, bool>: the index of the matching pivot and true, or the number of
+    * pivots that are smaller than key and false
+    */
+    std::pair<size_t, bool> _locate(const key_type& key) const { return _locate(key, 0, this->list.size()); }
+
+    /**
+    * @brief same as _locate, but the answer is known to lie in [lo, hi]
+    */
+    std::pair<size_t, bool> _locate(const key_type& key, size_t lo, size_t hi) const {
+        while(lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            auto c = _compare(key, _proj(this->list[mid].first));
+            if(c == 0) { return {mid, true}; }
+            if(c < 0) { hi = mid; }
+            else { lo = mid + 1; }
+        }
+        return {lo, false};
+    }
+
+    /**
+    * @brief finger search over the pivots, gallops away from idx with doubling steps until the
+    * answer is bracketed and then binary searches that range. A key that lands d buckets away from
+    * idx costs O(log d) comparisons, a key in the same bucket costs two
+    * @param idx: the bucket we start from
+    * @param key: the key we are looking for
+    * @return std::pair<size_t, bool>: the same as _locate
+    */
+    std::pair<size_t, bool> _locate_near(size_t idx, const key_type& key) const {
+        auto c = _compare(key, _proj(this->list[idx].first));
+        if(c == 0) { return {idx, true}; }
+        size_t step = 1;
+        if(c > 0) {
+            // every pivot before lo is smaller than key
+            size_t lo = idx + 1;
+            while(idx + step < this->list.size()) {
+                auto d = _compare(key, _proj(this->list[idx + step].first));
+                if(d == 0) { return {idx + step, true}; }
+                if(d < 0) { return _locate(key, lo, idx + step); }
+                lo = idx + step + 1;
+                step *= 2;
+            }
+            return _locate(key, lo, this->list.size());
+        }
+        // every pivot from hi on is bigger than key
+        size_t hi = idx;
+        while(step <= idx) {
+            auto d = _compare(key, _proj(this->list[idx - step].first));
+            if(d == 0) { return {idx - step, true}; }
+            if(d > 0) { return _locate(key, idx - step + 1, hi); }
+            hi = idx - step;
+            step *= 2;
+        }
+        return _locate(key, 0, hi);
+    }
+
+    /**
+    * @brief finds the bucket that owns key. Bucket i holds the pivot list[i].first and every
+    * key between it and the next pivot, bucket 0 also holds the keys smaller than the first pivot
+    * @param pos: the result of _locate for that key
+    * @return size_t: the bucket index, list must not be empty
+    */
+    static size_t _bucket(const std::pair<size_t, bool>& pos) {
+        if(pos.second) { return pos.first; }
+        return pos.first == 0 ? 0 : pos.first - 1;
+    }
+
+    const tree_type* _tree(size_t idx) const {
+        return this->list[idx].second ? &this->list[idx].second.value() : nullptr;
+    }
+
+    static size_t _tree_size(const std::optional<tree_type>& tree) { return tree ? tree.value().size() : 0; }
+
+    /**
+    * @brief the smallest key of the first bucket or the biggest key of the last one, either its
+    * pivot or the end of its tree. Only one spine is walked, no iterator is built
+    */
+    const T& _extreme_of(bool smallest) const {
+        size_t idx = smallest ? 0 : this->list.size() - 1;
+        const tree_type* tree = _tree(idx);
+        const T* end = tree ? (smallest ? tree->first() : tree->last()) : nullptr;
+        if(!end) { return this->list[idx].first; }
+        auto c = _compare(_proj(*end), _proj(this->list[idx].first));
+        return (smallest ? c < 0 : c > 0) ? *end : this->list[idx].first;
+    }
+
+    size_t _bucket_size(size_t idx) const { return 1 + _tree_size(this->list[idx].second); }
+
+    void _counts_build() const {
+        if(_counts_valid) { return; }
+        _counts.resize(this->list.size());
+        for(size_t i = 0; i < this->list.size(); i++) {
+            _counts[i] = _bucket_size(i);
+        }
+        for(size_t i = 1; i <= _counts.size(); i++) {
+            size_t parent = i + (i & -i);
+            if(parent <= _counts.size()) { _counts[parent - 1] += _counts[i - 1]; }
+        }
+        _counts_valid = true;
+    }
+
+    void _count_add(size_t idx, size_t delta) {
+        if(!_counts_valid) { return; }
+        for(size_t i = idx + 1; i <= _counts.size(); i += i & -i) {
+            _counts[i - 1] += delta;
+        }
+    }
+
+    /**
+    * @brief appends the count of a new last bucket, the new node sums the range it covers from
+    * the nodes below it
+    */
+    void _count_push(size_t size) {
+        if(!_counts_valid) { return; }
+        size_t i = _counts.size() + 1;
+        for(size_t j = i - 1; j > i - (i & -i); j -= j & -j) {
+            size += _counts[j - 1];
+        }
+        _counts.push_back(size);
+    }
+
+    /**
+    * @brief number of keys in the buckets before idx
+    */
+    size_t _count_prefix(size_t idx) const {
+        _counts_build();
+        size_t sum = 0;
+        for(; idx > 0; idx -= idx & -idx) {
+            sum += _counts[idx - 1];
+        }
+        return sum;
+    }
+
+    /**
+    * @brief descends the Fenwick tree to the bucket that holds the k-th smallest key
+    * @return std::pair<size_t, size_t>: the bucket and the position of the key inside it
+    */
+    std::pair<size_t, size_t> _count_search(size_t k) const {
+        _counts_build();
+        size_t idx = 0;
+        for(size_t step = std::bit_floor(_counts.size()); step > 0; step >>= 1) {
+            if(idx + step <= _counts.size() && _counts[idx + step - 1] <= k) {
+                idx += step;
+                k -= _counts[idx - 1];
+            }
+        }
+        return {idx, k};
+    }
+
+    static constexpr size_t _leaves = std::bit_ceil(_SIZE);
+
+    const key_type* _min_key(const key_type* a, const key_type* b) const {
+        return !a ? b : (!b || _compare(*a, *b) <= 0 ? a : b);
+    }
+
+    const key_type* _max_key(const key_type* a, const key_type* b) const {
+        return !a ? b : (!b || _compare(*a, *b) >= 0 ? a : b);
+    }
+
+    static aggregate_type _tree_fold(const tree_type* tree, const key_type* lo, const key_type* hi) {
+        if(!tree) { return Aggregate::identity(); }
+        if(lo && hi) { return tree->aggregate(*lo, *hi); }
+        if(lo) { return tree->aggregate_from(*lo); }
+        if(hi) { return tree->aggregate_below(*hi); }
+        return tree->aggregate();
+    }
+
+    /**
+    * @brief folds the keys of bucket idx that lie in [lo, hi) in sorted order, a null bound is
+    * open. Only bucket 0 has tree keys below its pivot
+    */
+    aggregate_type _bucket_fold(size_t idx, const key_type* lo, const key_type* hi) const {
+        const tree_type* tree = _tree(idx);
+        const key_type& pivot = _proj(this->list[idx].first);
+        aggregate_type result = idx == 0 ? _tree_fold(tree, lo, _min_key(hi, &pivot)) : Aggregate::identity();
+        if((!lo || _compare(pivot, *lo) >= 0) && (!hi || _compare(pivot, *hi) < 0)) {
+            result = Aggregate::combine(result, Aggregate::lift(this->list[idx].first));
+        }
+        return Aggregate::combine(result, _tree_fold(tree, _max_key(lo, &pivot), hi));
+    }
+
+    void _totals_build() const {
+        if(_totals_valid) { return; }
+        _totals.assign(2 * _leaves, Aggregate::identity());
+        for(size_t i = 0; i < this->list.size(); i++) {
+            _totals[_leaves + i] = _bucket_fold(i, nullptr, nullptr);
+        }
+        for(size_t i = _leaves; i-- > 1;) {
+            _totals[i] = Aggregate::combine(_totals[2 * i], _totals[2 * i + 1]);
+        }
+        _totals_valid = true;
+    }
+
+    void _total_update(size_t idx) {
+        if constexpr (has_aggregate) {
+            if(!_totals_valid) { return; }
+            size_t i = _leaves + idx;
+            _totals[i] = _bucket_fold(idx, nullptr, nullptr);
+            for(i /= 2; i > 0; i /= 2) {
+                _totals[i] = Aggregate::combine(_totals[2 * i], _totals[2 * i + 1]);
+            }
+        }
+    }
+
+    /**
+    * @brief folds the totals of the buckets in [first, last) in order
+    */
+    aggregate_type _totals_fold(size_t first, size_t last) const {
+        _totals_build();
+        aggregate_type left = Aggregate::identity(), right = Aggregate::identity();
+        for(first += _leaves, last += _leaves; first < last; first /= 2, last /= 2) {
+            if(first & 1) { left = Aggregate::combine(left, _totals[first++]); }
+            if(last & 1) { right = Aggregate::combine(_totals[--last], right); }
+        }
+        return Aggregate::combine(left, right);
+    }
+
+    /**
+    * @brief bookkeeping after the keys of bucket idx changed but the pivot array did not
+    */
+    void _bucket_changed(size_t idx, size_t delta) {
+        _count_add(idx, delta);
+        _total_update(idx);
+        if(_shared.on) { _trees_written(); }
+    }
+
+    /**
+    * @brief bookkeeping after a tree was written while it may share nodes with a copy
+    */
+    void _trees_written() {
+        _cached_min.key = nullptr;
+        _cached_max.key = nullptr;
+    }
+
+    /**
+    * @brief bookkeeping after a bucket was pushed behind the last one
+    */
+    void _bucket_opened() {
+        _count_push(1);
+        _total_update(this->list.size() - 1);
+        // the push may have moved the pivots, but the new last pivot is the biggest key
+        _cached_min.key = nullptr;
+        _cached_max.key = &this->list.back().first;
+    }
+
+    /**
+    * @brief whether the last bucket should be spread over a new pivot: there is a free pivot slot
+    * and its tree holds twice as many keys as there are pivots, or as a full pivot array would
+    * give every bucket
+    */
+    bool _spread_due() const {
+        if(this->list.size() >= _SIZE) { return false; }
+        size_t size = _tree_size(this->list.back().second);
+        return size >= 2 * std::max(_size / _SIZE, this->list.size());
+    }
+
+    /**
+    * @brief spreads the last bucket over a new pivot once _spread_due says so. Keys that keep
+    * landing behind the last pivot, like the deadlines of a scheduler, would otherwise pile up
+    * in that one tree. Its upper half is split off in O(log n) and the smallest key of that half
+    * becomes the new last pivot, iterators into the bucket are invalid afterwards
+    */
+    void _spread_last() {
+        size_t idx = this->list.size() - 1;
+        std::optional<tree_type>& tree = this->list[idx].second;
+        size_t size = _tree_size(tree);
+        tree_type upper = tree.value().split(_proj(*tree.value().select(size / 2)));
+        T pivot = upper.pop_min();
+        size_t moved = upper.size() + 1;
+        _count_add(idx, -moved);
+        _total_update(idx);
+        this->list.push_back({std::move(pivot), std::move(upper)});
+        _count_push(moved);
+        _total_update(idx + 1);
+        _version++;
+        // the push may have moved the pivots and the old maximum may have been the new pivot
+        _cached_min.key = nullptr;
+        _cached_max.key = nullptr;
+    }
+
+    /**
+    * @brief bookkeeping after pivots moved, the summaries are rebuilt by the next query
+    */
+    void _pivots_changed() {
+        _counts_valid = false;
+        _totals_valid = false;
+        _cached_min.key = nullptr;
+        _cached_max.key = nullptr;
+    }
+
+    /**
+    * @brief moves the cached extremes to a key that was just inserted into a tree, tree nodes
+    * never move so the pointer stays valid until that key is removed
+    */
+    void _note_inserted(const T& key) {
+        if(_cached_min.key && _compare(_proj(key), _proj(*_cached_min.key)) < 0) { _cached_min.key = &key; }
+        if(_cached_max.key && _compare(_proj(key), _proj(*_cached_max.key)) > 0) { _cached_max.key = &key; }
+    }
+
+    /**
+    * @brief removes key from bucket idx, either its pivot or a key of its tree
+    * @return size_t: the number of removed keys, 0 or 1
+    */
+    size_t _erase(size_t idx, bool pivot, const key_type& key);
+
+    /**
+    * @brief links the node of nh into the tree of its key's bucket
+    * @param nh: the node, it is left untouched if its key already exists
+    * @return std::pair<const_iterator, bool>: the same as insert
+    */
+    std::pair<const_iterator, bool> _insert_node(typename tree_type::node_handle& nh);
+
+    /**
+    * @brief unlinks the node that holds key from the tree of bucket idx
+    * @return node_type: the node, or an empty handle if the tree does not hold key
+    */
+    node_type _extract_tree(size_t idx, const key_type& key);
+
+    /**
+    * @brief the search and insertion behind find_or_insert
+    * @param unshare: whether a key that exists is copied out of the tree nodes a copy of this
+    * bubble shares, for callers that change its mutable members
+    */
+    template <typename F>
+    std::pair<const_iterator, bool> _find_or_insert(const const_iterator& hint, const key_type& key, F& make, bool unshare);
+
+    size_t _erase_range(const key_type* lo, const key_type* hi);
+
+    /**
+    * @brief builds a bubble with at most buckets pivots from strictly increasing keys, the keys
+    * are spread evenly and every tree is linked in O(n) without comparisons
+    */
+    static bubble _from_sorted(std::vector<T>&& keys, size_t buckets);
+
+    /**
+    * @brief the slicing and reassembly shared by the set operations, merge(a_first, a_last,
+    * b_first, b_last, out, less) writes the result of one slice to out like the std algorithms
+    */
+    template <typename Merge>
+    static bubble _set_operation(const bubble& a, const bubble& b, size_t threads, Merge merge);
+
+    /**
+    * @brief removes the pivot of bucket idx, the smallest key of its tree takes its place
+    * @return true: if the bucket is empty now and its slot has to be dropped
+    * @return false: otherwise
+    */
+    bool _drop_pivot(size_t idx) {
+        std::optional<tree_type>& tree = this->list[idx].second;
+        if(_tree_size(tree) == 0) { return true; }
+        this->list[idx].first = tree.value().pop_min();
+        return false;
+    }
+
+    /**
+    * @brief removes the slots marked in dropped with a single pass over the pivot array
+    */
+    void _compact(const std::vector<bool>& dropped) {
+        size_t kept = 0;
+        for(size_t i = 0; i < this->list.size(); i++) {
+            if(dropped[i]) { continue; }
+            if(kept != i) { this->list[kept] = std::move(this->list[i]); }
+            kept++;
+        }
+        this->list.erase(std::ranges::begin(this->list) + kept, std::ranges::end(this->list));
+    }
+
+    /**
+    * @brief shrinks the pivot array to target buckets in a single pass. The list.size() - target
+    * boundaries whose two neighbouring buckets hold the fewest keys are picked with one selection,
+    * then the array is rebuilt once and every picked pivot joins the trees on its two sides, so m
+    * merges cost O(_SIZE + m log n) instead of a scan of the array per merge
+    * @param target: the number of buckets to keep, at least 1
+    */
+    void _merge_down(size_t target) {
+        assert(target > 0);
+        const size_t n = this->list.size();
+        if(n <= target) { return; }
+        const size_t merges = n - target;
+        // (keys in the two buckets around the boundary, the index of the pivot on the boundary)
+        std::vector<std::pair<size_t, size_t>> boundaries;
+        boundaries.reserve(n - 1);
+        for(size_t i = 1; i < n; i++) {
+            boundaries.push_back({_tree_size(this->list[i - 1].second) + _tree_size(this->list[i].second), i});
+        }
+        std::ranges::nth_element(boundaries, std::ranges::begin(boundaries) + (merges - 1));
+        std::vector<bool> merged(n, false);
+        for(size_t j = 0; j < merges; j++) { merged[boundaries[j].second] = true; }
+
+        size_t kept = 0;
+        for(size_t i = 1; i < n; i++) {
+            if(!merged[i]) {
+                if(++kept != i) { this->list[kept] = std::move(this->list[i]); }
+                continue;
+            }
+            std::optional<tree_type>& into = this->list[kept].second;
+            tree_type left = into ? std::move(into.value()) : tree_type();
+            tree_type right = this->list[i].second ? std::move(this->list[i].second.value()) : tree_type();
+            into = tree_type::join(std::move(left), std::move(this->list[i].first), std::move(right));
+        }
+        this->list.erase(std::ranges::begin(this->list) + (kept + 1), std::ranges::end(this->list));
+        _version++;
+        _pivots_changed();
+    }
+
+public:
+    /**
+    * @brief default constructor of bubble
+    */
+    explicit bubble() noexcept : _size(0) { }
+
+    /**
+    * @brief converting constructor of bubble, re-buckets a bubble that has a different number of
+    * pivot slots. The sorted keys are streamed out once, spread over evenly spaced new pivots and
+    * every tree is built balanced from its run of keys, so it costs O(n) without any comparison
+    * @param t: const& bubble<T, _NEW_SIZE>: the bubble to convert
+    */
+    template <size_t _NEW_SIZE>
+    requires (_NEW_SIZE != _SIZE)
+    bubble(const bubble<T, _NEW_SIZE, Compare, Projection, Aggregate> &t) : _size(0) {
+        std::vector<T> keys;
+        keys.reserve(t.size());
+        std::ranges::copy(t.cbegin(), t.cend(), std::back_inserter(keys));
+        *this = _from_sorted(std::move(keys), _SIZE);
+    }
+
+    /**
+    * @brief operator = for bubble class, converts t the same way as the converting constructor
+    * @param t: const& bubble<T, _NEW_SIZE> the bubble to convert
+    * @return bubble&: this bubble
+    */
+    template <size_t _NEW_SIZE>
+    requires (_NEW_SIZE != _SIZE)
+    bubble& operator =(const bubble<T, _NEW_SIZE, Compare, Projection, Aggregate> &t) {
+        uint64_t version = _version;
+        *this = bubble(t);
+        // iterators and hints of the old contents must not match the new ones
+        _version = version + 1;
+        return *(this);
+    }
+
+    /**
+    * @brief insert function for bubble
+    * @param key: the key you want to insert
+    * @return std::pair<const_iterator, bool>: an iterator to the element with that key and true
+    * if it was inserted, false if it already existed
+    */
+    std::pair<const_iterator, bool> insert(const T& key) {
+        return find_or_insert(_proj(key), [&]() { return key; });
+    }
+
+    /**
+    * @brief insert function for bubble
+    * @param Args: the keys you want to insert. You can insert as many as you like
+    * bubble.insert(1, 2, 3, 4, ...)
+    * @return size_t: the number of keys that did not exist
+    */
+    template <typename... Args>
+    requires (sizeof...(Args) > 1 && (!std::same_as<std::remove_cvref_t<Args>, const_iterator> && ...))
+    size_t insert(Args&& ...keys) {
+        return (static_cast<size_t>(this->insert(T(std::forward<Args>(keys))).second) + ...);
+    }
+
+    /**
+    * @brief find_or_insert function for bubble, looks key up and creates its element during the
+    * same pivot search and tree descent if it does not exist
+    * @param key: the key you want to find
+    * @param make: callable that returns the T to insert, it is only invoked when key is missing and
+    * the projection of its result must be equal to key
+    * @return std::pair<const_iterator, bool>: an iterator to the element with that key and true
+    * if it was created. An element that already existed may still be shared with a copy of this
+    * bubble, so its mutable members must not be changed
+    */
+    template <typename F>
+    std::pair<const_iterator, bool> find_or_insert(const key_type& key, F&& make);
+
+    /**
+    * @brief find_or_insert_unshared function for bubble, a find_or_insert for elements whose mutable
+    * members are about to change. An element that already exists is shared with no copy of this
+    * bubble afterwards, like with find_unshared
+    */
+    template <typename F>
+    std::pair<const_iterator, bool> find_or_insert_unshared(const key_type& key, F&& make);
+
+    /**
+    * @brief append function for bubble, the write path of increasing key streams. A key that is
+    * bigger than every stored key skips the pivot search and goes down the right spine of the last
+    * bucket. Once that bucket holds more than its share of the keys the key opens a new bucket
+    * instead, and if every pivot slot is taken the two smallest neighbouring buckets are merged to
+    * free one. Any other key falls back to insert
+    * @param key: the key you want to append
+    * @return std::pair<const_iterator, bool>: the same as insert
+    */
+    std::pair<const_iterator, bool> append(const T& key);
+
+    /**
+    * @brief hinted insert function for bubble, in the style of std::set::insert(hint, value). The
+    * pivot search gallops outwards from the hint's bucket and the tree search climbs from the hint's
+    * node, so a key that lands d keys away from the hint costs O(log d) comparisons
+    * @param hint: an iterator of this bubble, usually the one returned by the previous insertion.
+    * It is ignored if the bubble changed since it was obtained
+    * @param key: the key you want to insert
+    * @return std::pair<const_iterator, bool>: an iterator to the element with that key and true
+    * if it was inserted
+    */
+    std::pair<const_iterator, bool> insert(const const_iterator& hint, const T& key) {
+        return find_or_insert(hint, _proj(key), [&]() { return key; });
+    }
+
+    /**
+    * @brief hinted find_or_insert function for bubble
+    * @param hint: an iterator of this bubble, ignored if the bubble changed since it was obtained
+    */
+    template <typename F>
+    std::pair<const_iterator, bool> find_or_insert(const const_iterator& hint, const key_type& key, F&& make);
+
+    /**
+    * @brief remove function for bubble
+    * @param key: the key you want to remove
+    * @return size_t: the number of removed keys, 0 or 1
+    */
+    size_t remove(const key_type& key);
+
+    /**
+    * @brief remove function for bubble
+    * @param Args: the keys you want to remove. You can remove as many as you like
+    * bubble.remove(1, 2, 3, 4, ...)
+    * @return size_t: the number of removed keys
+    */
+    template <typename... Args>
+    requires (sizeof...(Args) > 1)
+    size_t remove(Args&& ...keys) {
+        return (this->remove(key_type(std::forward<Args>(keys))) + ...);
+    }
+
+    /**
+    * @brief erase function for bubble, removes every key in [first, last). The buckets that lie
+    * completely inside the range are dropped as a whole, the two boundary buckets are cut with an
+    * avl split and the pivot array is compacted once, so it costs O(m + log n) plus freeing the keys
+    * @param first: the smallest key of the range
+    * @param last: the end of the range, it is not removed
+    * @return size_t: the number of removed keys
+    */
+    size_t erase(const key_type& first, const key_type& last) { return _erase_range(&first, &last); }
+
+    /**
+    * @brief erase_below function for bubble, removes every key smaller than key in the same way
+    * as erase, the usual way to expire a sliding window
+    * @param key: the watermark, it is not removed
+    * @return size_t: the number of removed keys
+    */
+    size_t erase_below(const key_type& key) { return _erase_range(nullptr, &key); }
+
+    /**
+    * @brief erase_if function for bubble, removes every key that satisfies pred. Every tree is
+    * rebuilt from its survivors in one pass and the pivot array is compacted once
+    * @param pred: callable that takes a const T&
+    * @return size_t: the number of removed keys
+    */
+    template <typename Pred>
+    size_t erase_if(Pred pred);
+
+    /**
+    * @brief split function for bubble, moves every key that is not smaller than key into a new
+    * bubble. Whole buckets change hands and the one bucket that holds key is cut with an avl split,
+    * so nothing is reinserted and it costs O(m + log n)
+    * @param key: the first key that moves
+    * @return bubble: the keys not smaller than key, this bubble keeps the rest
+    */
+    bubble split(const key_type& key);
+
+    /**
+    * @brief concat function for bubble, moves every key of other into this bubble when the two
+    * key ranges do not overlap, in either order. The buckets of other are taken over as they are,
+    * only the keys of its first bucket that lie below its pivot are joined into a neighbouring tree,
+    * and if the pivots do not fit the smallest neighbouring buckets are merged in one pass over the
+    * pivot array, O(_SIZE + _SIZE log n)
+    * @param other: the bubble whose keys are taken, it is left empty on success
+    * @return true: if the keys were moved
+    * @return false: if the ranges overlap, then neither bubble changes
+    */
+    bool concat(bubble&& other);
+
+    /**
+    * @brief set_union function for bubble. The key space is cut into one slice per thread at keys
+    * picked by rank from the bigger input, every slice is merged from the two key streams and
+    * built into a bubble of its own in parallel, and the slices are put together with concat
+    * @param a: the first bubble, its element wins when both hold a key
+    * @param b: the second bubble
+    * @param threads: the most threads to use, small inputs use fewer
+    * @return bubble: every key of a or b
+    */
+    static bubble set_union(const bubble& a, const bubble& b, size_t threads = std::thread::hardware_concurrency());
+
+    /**
+    * @brief set_intersection function for bubble, parallel in the same way as set_union
+    * @return bubble: the elements of a whose key is also in b
+    */
+    static bubble set_intersection(const bubble& a, const bubble& b, size_t threads = std::thread::hardware_concurrency());
+
+    /**
+    * @brief set_difference function for bubble, parallel in the same way as set_union
+    * @return bubble: the elements of a whose key is not in b
+    */
+    static bubble set_difference(const bubble& a, const bubble& b, size_t threads = std::thread::hardware_concurrency());
+
+    /**
+    * @brief min function for bubble, O(1) from a cached pointer. The cache is refreshed by one
+    * spine walk of the first tree after the smallest key is removed or the pivot array changes
+    * @return const T&: the smallest key, the bubble must not be empty
+    */
+    const T& min() const {
+        assert(this->_size > 0);
+        if(!_cached_min.key) { _cached_min.key = &_extreme_of(true); }
+        return *_cached_min.key;
+    }
+
+    /**
+    * @brief max function for bubble, cached the same way as min
+    * @return const T&: the biggest key, the bubble must not be empty
+    */
+    const T& max() const {
+        assert(this->_size > 0);
+        if(!_cached_max.key) { _cached_max.key = &_extreme_of(false); }
+        return *_cached_max.key;
+    }
+
+    /**
+    * @brief pop_min function for bubble, removes the smallest key without searching the pivots.
+    * It is always in bucket 0 and the cache tells whether it is the pivot or the leftmost node of
+    * the tree. This is not O(1): unlinking a tree node walks the left spine of bucket 0 and
+    * updates the subtree size of every node on it, O(log b) for a bucket of b keys, and the
+    * cache is refilled by one more spine walk. Popping the pivot of a bucket that has nothing
+    * else erases its slot, which shifts the pivot array in O(m)
+    * @return T: the removed key, the bubble must not be empty
+    */
+    T pop_min() {
+        const T& smallest = min();
+        if(&smallest == &this->list.front().first) {
+            T key = std::move(this->list.front().first);
+            _erase(0, true, _proj(key));
+            return key;
+        }
+        T key = this->list.front().second.value().pop_min();
+        _cached_min.key = nullptr;
+        _size--;
+        _bucket_changed(0, -1);
+        return key;
+    }
+
+    /**
+    * @brief pop_max function for bubble, the biggest key is always in the last bucket. It costs
+    * the same as pop_min, O(log b) along the right spine of the last bucket
+    * @return T: the removed key, the bubble must not be empty
+    */
+    T pop_max() {
+        const T& biggest = max();
+        size_t idx = this->list.size() - 1;
+        if(&biggest == &this->list[idx].first) {
+            T key = std::move(this->list[idx].first);
+            _erase(idx, true, _proj(key));
+            return key;
+        }
+        T key = this->list[idx].second.value().pop_max();
+        _cached_max.key = nullptr;
+        _size--;
+        _bucket_changed(idx, -1);
+        return key;
+    }
+
+    /**
+    * @brief replace_min function for bubble, evicts the smallest key and inserts key in one step.
+    * When the smallest key lives in a tree its node is unlinked without a search and relinked
+    * with the new key, so a full bounded bubble does not allocate. If key already exists the
+    * evicted key is put back and nothing changes
+    * @param key: the key you want to insert, the bubble must not be empty
+    * @return std::pair<const_iterator, bool>: the same as insert
+    */
+    std::pair<const_iterator, bool> replace_min(const T& key);
+
+    /**
+    * @brief extract function for bubble, unlinks the element with that key and hands its node
+    * over instead of freeing it, like std::set::extract. A pivot hands over the node of the
+    * smallest key of its bucket, which becomes the new pivot. Only a pivot that is alone in its
+    * bucket has no node, one is allocated for it then
+    * @param key: the key you want to extract
+    * @return node_type: the element, or an empty handle if key does not exist
+    */
+    node_type extract(const key_type& key);
+
+    /**
+    * @brief take function for bubble, removes the element with that key in a single search and
+    * returns it. Unlike extract it never allocates, a pivot is moved out of its slot
+    * @param key: the key you want to remove
+    * @return std::optional<T>: the removed element, or std::nullopt if key does not exist
+    */
+    std::optional<T> take(const key_type& key);
+
+    /**
+    * @brief insert function for bubble, links the node of nh into the tree of its bucket without
+    * allocating
+    * @param nh: the element to insert, an empty handle inserts nothing
+    * @return insert_return_type: the position of the key, whether it was inserted and the node
+    * back if the key already existed
+    */
+    insert_return_type insert(node_type&& nh) {
+        if(nh.empty()) { return {cend(), false, node_type()}; }
+        auto [it, inserted] = _insert_node(nh);
+        return {it, inserted, std::move(nh)};
+    }
+
+    /**
+    * @brief merge function for bubble, moves every element of other whose key does not exist here
+    * into this bubble, like std::set::merge. Bubbles whose ranges do not overlap are joined with
+    * concat, otherwise the tree nodes of other are relinked one by one. Its pivots are stored by
+    * value and have no node, so each of them that lands in a tree here, or goes back to a tree of
+    * other, allocates one: at most one allocation per bucket of other
+    * @param other: the bubble to take the elements from, it keeps the keys that exist in both
+    */
+    void merge(bubble& other);
+
+    /**
+    * @brief search function for bubble
+    * @param key: the key you want to search
+    * @return true: if key exists in the bubble
+    * @return false: otherwise
+    */
+    bool search(const key_type& key) const;
+
+    /**
+    * @brief find function for bubble
+    * @param key: the key you want to find
+    * @return const_iterator: an iterator to the stored element or cend() if key does not exist
+    */
+    const_iterator find(const key_type& key) const;
+
+    /**
+    * @brief hinted find function for bubble, the search starts from the hint and moves outwards
+    * @param hint: an iterator of this bubble, ignored if the bubble changed since it was obtained
+    * @param key: the key you want to find
+    * @return const_iterator: an iterator to the stored element or cend() if key does not exist
+    */
+    const_iterator find(const const_iterator& hint, const key_type& key) const;
+
+    /**
+    * @brief find_unshared function for bubble, a find for elements whose mutable members are about
+    * to change. The element is shared with no copy of this bubble afterwards, the tree path to it is
+    * copied in the same descent where a copy still shares it
+    * @param key: the key you want to find
+    * @return const_iterator: an iterator to the stored element or cend() if key does not exist
+    */
+    const_iterator find_unshared(const key_type& key);
+
+    /**
+    * @brief lower_bound function for bubble, one pivot search picks the bucket and one tree
+    * descent finds the key inside it
+    * @param key: the key you want to look for
+    * @return const_iterator: the first element that is not smaller than key, or cend()
+    */
+    const_iterator lower_bound(const key_type& key) const;
+
+    /**
+    * @brief upper_bound function for bubble
+    * @param key: the key you want to look for
+    * @return const_iterator: the first element that is bigger than key, or cend()
+    */
+    const_iterator upper_bound(const key_type& key) const {
+        const_iterator it = lower_bound(key);
+        if(it != cend() && _compare(_proj(*it), key) == 0) { ++it; }
+        return it;
+    }
+
+    /**
+    * @brief equal_range function for bubble
+    * @param key: the key you want to look for
+    * @return std::pair<const_iterator, const_iterator>: the range of elements equal to key, it
+    * holds at most one element
+    */
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+        const_iterator first = lower_bound(key);
+        const_iterator last = first;
+        if(last != cend() && _compare(_proj(*last), key) == 0) { ++last; }
+        return {first, last};
+    }
+
+    /**
+    * @brief predecessor function for bubble
+    * @param key: the key you want to look for, it does not have to exist
+    * @return const_iterator: the biggest element that is smaller than key, or cend()
+    */
+    const_iterator predecessor(const key_type& key) const {
+        const_iterator it = lower_bound(key);
+        return it == cbegin() ? cend() : --it;
+    }
+
+    /**
+    * @brief successor function for bubble
+    * @param key: the key you want to look for, it does not have to exist
+    * @return const_iterator: the smallest element that is bigger than key, or cend()
+    */
+    const_iterator successor(const key_type& key) const { return upper_bound(key); }
 
-public:
     /**
-    * @brief default constructor of bubble
+    * @brief range function for bubble, a lazy view over the keys in [first, last). Only the
+    * start is searched for, the view then streams through the trees and the following pivots
+    * and the end is found when the walk reaches it
+    * @param first: the smallest key of the range
+    * @param last: the end of the range, it is not included
+    * @return std::ranges::subrange<const_iterator>: the keys in [first, last) in sorted order
     */
-    explicit bubble() noexcept : _size(0) { }
+    std::ranges::subrange<const_iterator> range(const key_type& first, const key_type& last) const {
+        const_iterator begin = lower_bound(first);
+        if(_compare(first, last) >= 0) { return {begin, begin}; }
+        return {begin, lower_bound(last)};
+    }
 
     /**
-    * @brief copy constructor of bubble
-    * @param t: const& bubble<T, _NEW_SIZE>: the new bubble
+    * @brief rank function for bubble, the keys of the buckets before the key's bucket come from a
+    * Fenwick tree over the bucket sizes and the rest from the subtree sizes of its tree, so this
+    * costs O(log _SIZE + log m) for buckets of m keys
+    * @param key: the key you want to rank, it does not have to exist
+    * @return size_t: the number of keys smaller than key
     */
-    template <size_t _NEW_SIZE>
-    bubble(const bubble<T, _NEW_SIZE> &t) : _size(0) {
-        try {
-            if(_NEW_SIZE != _SIZE) {
-                throw std::logic_error("Tried to copy bubbles with different sizes");
-                return;
-            }
-            this->_size = t.size();
-            this->list = {};
-            for(size_t i = 0; i<this->_size; i++){
-                this->list.push_back(std::pair<T, std::optional<avl_tree<T>>>(t.get_key(i), t.get_tree(i)));
-            }
-        }
-        catch (std::logic_error &e){
-            std::cerr << e.what() << '\n';
-        }
+    size_t rank(const key_type& key) const;
+
+    /**
+    * @brief select function for bubble
+    * @param k: zero based position in sorted order
+    * @return const_iterator: an iterator to the k-th smallest key, or cend() if k >= size()
+    */
+    const_iterator select(size_t k) const;
+
+    /**
+    * @brief count function for bubble
+    * @param first: the smallest key of the range
+    * @param last: the end of the range, it is not included
+    * @return size_t: the number of keys in [first, last)
+    */
+    size_t count(const key_type& first, const key_type& last) const {
+        return _compare(first, last) < 0 ? rank(last) - rank(first) : 0;
     }
 
     /**
-    * @brief operator = for bubble class
-    * @param t: const& bubble<T, _NEW_SIZE> the new bubble
-    * @return: const bubble
+    * @brief aggregate function for bubble, folds Aggregate over the keys in [first, last). The
+    * buckets in between come from a segment tree over the bucket totals and the two boundary
+    * buckets from the subtree aggregates of their trees, so this is O(log _SIZE + log m)
+    * @param first: the smallest key of the range
+    * @param last: the end of the range, it is not included
+    * @return aggregate_type: the folded value, Aggregate::identity() for an empty range
     */
-    template <size_t _NEW_SIZE>
-    const bubble operator =(bubble<T, _NEW_SIZE> &t) {
-        try{
-            if(_NEW_SIZE != _SIZE) {
-                throw std::logic_error("Tried to copy two bubbles with different sizes");
-            }
-            this->_size = t.size();
-            this->list = {};
-            for(size_t i = 0; i<this->_size; i++){
-                this->list.push_back(std::pair<T, std::optional<avl_tree<T>>>(t.get_key(i), t.get_tree(i)));
-            }
-        }
-        catch (std::logic_error &e) {
-            std::cerr << e.what() << '\n';
-            return *(this);
-        }
-        return *(this);
+    aggregate_type aggregate(const key_type& first, const key_type& last) const requires has_aggregate {
+        if(this->list.empty() || _compare(first, last) >= 0) { return Aggregate::identity(); }
+        size_t a = _bucket(_locate(first)), b = _bucket(_locate(last));
+        if(a == b) { return _bucket_fold(a, &first, &last); }
+        return Aggregate::combine(Aggregate::combine(_bucket_fold(a, &first, nullptr), _totals_fold(a + 1, b)),
+                                  _bucket_fold(b, nullptr, &last));
     }
 
     /**
-    * @brief insert function for bubble
-    * @param Args: the keys you want to insert. You can insert as many as you like
-    * bubble.insert(1, 2, 3, 4, ...)
+    * @brief aggregate_below function for bubble, folds Aggregate over the keys smaller than key
     */
-    template <typename... Args>
-    void insert(Args ...keys);
+    aggregate_type aggregate_below(const key_type& key) const requires has_aggregate {
+        if(this->list.empty()) { return Aggregate::identity(); }
+        size_t b = _bucket(_locate(key));
+        return Aggregate::combine(_totals_fold(0, b), _bucket_fold(b, nullptr, &key));
+    }
 
     /**
-    * @brief remove function for bubble
-    * @param Args: the keys you want to remove. You can remove as many as you like
-    * bubble.remove(1, 2, 3, 4, ...)
+    * @brief sum function for bubble, available when Aggregate keeps a sum, e.g. sum_min_max
+    * @return the sum of the values of the keys in [first, last)
     */
-    template <typename... Args>
-    void remove(Args ...keys);
+    auto sum(const key_type& first, const key_type& last) const requires has_aggregate && requires(aggregate_type v) { v.sum; } {
+        return aggregate(first, last).sum;
+    }
 
     /**
-    * @brief search function for bubble
-    * @param key: the key you want to search
-    * @return true: if key exists in the bubble
-    * @return false: otherwise
+    * @brief max_below function for bubble, available when Aggregate keeps a maximum
+    * @return the biggest value among the keys smaller than x, or std::nullopt if there are none
     */
-    bool search(const T& key);
+    auto max_below(const key_type& x) const requires has_aggregate && requires(aggregate_type v) { v.max; } {
+        using value = decltype(std::declval<aggregate_type>().max);
+        if(this->_size == 0 || _compare(_proj(*cbegin()), x) >= 0) { return std::optional<value>(); }
+        return std::optional<value>(aggregate_below(x).max);
+    }
 
     /**
     * @brief get_key function
@@ -115,9 +1012,18 @@ public:
     /**
     * @brief get_tree function
     * @param index: const size_t& the index
-    * @return avl_tree<T>: the AVL Tree in that index
+    * @return tree_type: the AVL Tree in that index
+    */
+    tree_type get_tree(const size_t& index) const;
+
+    /**
+    * @brief snapshot function for bubble, a frozen copy in O(_SIZE). Only the pivot array is
+    * copied, the trees share every node with this bubble and a later write on either side copies
+    * just the O(log n) nodes on its path. The snapshot is an ordinary bubble, take it on the
+    * thread that writes and hand each reader its own
+    * @return bubble: a copy of the current contents
     */
-    avl_tree<T> get_tree(const size_t& index) const;
+    bubble snapshot() const { return *this; }
 
     /**
     * @brief iterator class for bubble container
@@ -134,7 +1040,19 @@ public:
     * @brief end iterator
     * @return an iterator to the ending of the list
     */
-    iterator end() noexcept { return iterator(this->list, _SIZE); }
+    iterator end() noexcept { return iterator(this->list, this->list.size()); }
+
+    /**
+    * @brief cbegin iterator
+    * @return a const_iterator to the smallest key of the bubble
+    */
+    const_iterator cbegin() const noexcept;
+
+    /**
+    * @brief cend iterator
+    * @return a const_iterator past the biggest key of the bubble
+    */
+    const_iterator cend() const noexcept { return const_iterator(this); }
 
     /**
     * @brief size function for bubble
@@ -148,6 +1066,12 @@ public:
     */
     size_t array_size() const;
 
+    /**
+    * @brief pivots function for bubble
+    * @return size_t: the number of pivots currently stored in the array
+    */
+    size_t pivots() const;
+
     /**
     * @brief empty function for bubble
     * @return true: if bubble is empty
@@ -161,7 +1085,7 @@ public:
     * @return std::vector<T>: the elements in-order of the passed index
     */
     std::pair<T, std::vector<T>> operator[] (const size_t& index) const {
-        assert(index < _SIZE && index >= 0);
+        assert(index < this->list.size());
         if(this->list[index].second == std::nullopt) { return {std::make_pair(this->list[index].first, std::vector<T>())}; }
         return std::make_pair(this->list[index].first, this->list[index].second.value().inorder());
     }
@@ -169,7 +1093,7 @@ public:
     /**
     * @brief operator << for bubble
     */
-    friend std::ostream & operator << (std::ostream &out, const bubble<T, _SIZE> &t){
+    friend std::ostream & operator << (std::ostream &out, const bubble &t){
         if(t._size == 0) { return out; }
         for(auto && x : t.list) {
             out << x.first << ": {";
@@ -177,7 +1101,7 @@ public:
                 out << "}" << '\n';
                 continue;
             }
-            avl_tree<T> tmp_tree(x.second.value());
+            tree_type tmp_tree(x.second.value());
             std::vector<T> ino = tmp_tree.inorder();
             for(size_t i = 0; i<ino.size(); i++){
                 if(i == ino.size() - 1) {
@@ -193,158 +1117,624 @@ public:
     }
 };
 
-template <typename T, size_t _SIZE>
-template <typename... Args>
-inline void bubble<T, _SIZE>::insert(Args ...keys) {
-    auto _insert = [&](const T&& key) -> void {
-        if(_size < _SIZE) {
-            this->list.push_back({key, std::nullopt});
-            _size++;
-            return;
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+template <typename F>
+std::pair<typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator, bool> bubble<T, _SIZE, Compare, Projection, Aggregate>::find_or_insert(const key_type& key, F&& make) {
+    return find_or_insert(cend(), key, std::forward<F>(make));
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+template <typename F>
+std::pair<typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator, bool> bubble<T, _SIZE, Compare, Projection, Aggregate>::find_or_insert(const const_iterator& hint, const key_type& key, F&& make) {
+    return _find_or_insert(hint, key, make, false);
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+template <typename F>
+std::pair<typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator, bool> bubble<T, _SIZE, Compare, Projection, Aggregate>::find_or_insert_unshared(const key_type& key, F&& make) {
+    return _find_or_insert(cend(), key, make, true);
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+template <typename F>
+std::pair<typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator, bool> bubble<T, _SIZE, Compare, Projection, Aggregate>::_find_or_insert(const const_iterator& hint, const key_type& key, F& make, bool unshare) {
+    bool valid = hint.b == this && hint.version == _version && hint.idx < this->list.size();
+    std::pair<size_t, bool> pos = valid ? _locate_near(hint.idx, key) : _locate(key);
+    if(pos.second) { return {const_iterator(this, pos.first), false}; }
+    if(this->_size == this->list.size() && this->list.size() < _SIZE) {
+        this->list.insert(std::ranges::begin(this->list) + pos.first, {make(), std::nullopt});
+        _size++;
+        _version++;
+        _pivots_changed();
+        return {const_iterator(this, pos.first), true};
+    }
+
+    size_t idx = _bucket(pos);
+    if(this->list[idx].second == std::nullopt) {
+        this->list[idx].second = tree_type();
+    }
+    tree_type& tree = this->list[idx].second.value();
+    auto [it, inserted] = unshare ? tree.find_or_insert_unshared(key, make)
+                        : valid && idx == hint.idx ? tree.find_or_insert(hint.t, key, make) : tree.find_or_insert(key, make);
+    if(inserted) {
+        _size++;
+        _bucket_changed(idx, 1);
+        _note_inserted(*it);
+        if(idx + 1 == this->list.size() && _spread_due()) {
+            _spread_last();
+            return {find(key), true};
         }
-        if(_size == _SIZE) {
-            std::ranges::sort(this->list, [](const std::pair<T, std::optional<avl_tree<T>>> &a, const std::pair<T, std::optional<avl_tree<T>>> &b){
-                return a.first < b.first;
-            });
+    }
+    else if(unshare && _shared.on) { _trees_written(); }
+    return {const_iterator(this, idx, it), inserted};
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+std::pair<typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator, bool> bubble<T, _SIZE, Compare, Projection, Aggregate>::append(const T& key) {
+    if(this->list.empty() || _compare(_proj(key), _proj(this->list.back().first)) <= 0) { return insert(key); }
+    if(this->_size == this->list.size() && this->list.size() < _SIZE) {
+        this->list.push_back({key, std::nullopt});
+        _size++;
+        _version++;
+        _bucket_opened();
+        return {const_iterator(this, this->list.size() - 1), true};
+    }
+
+    size_t idx = this->list.size() - 1;
+    std::optional<tree_type>& tree = this->list[idx].second;
+    if(_SIZE > 1 && _tree_size(tree) >= std::max(_size / this->list.size(), this->list.size())) {
+        if(_compare(_proj(key), _proj(*tree.value().last())) <= 0) { return insert(key); }
+        if(this->list.size() == _SIZE) { _merge_down(_SIZE - 1); }
+        this->list.push_back({key, std::nullopt});
+        _size++;
+        _version++;
+        _bucket_opened();
+        return {const_iterator(this, this->list.size() - 1), true};
+    }
+    if(tree == std::nullopt) {
+        tree = tree_type();
+    }
+    auto [it, appended] = tree.value().append(key);
+    if(!appended) { return insert(key); }
+    _size++;
+    _bucket_changed(idx, 1);
+    _note_inserted(*it);
+    return {const_iterator(this, idx, it), true};
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+size_t bubble<T, _SIZE, Compare, Projection, Aggregate>::remove(const key_type& key) {
+    if(this->_size == 0) { return 0; }
+    std::pair<size_t, bool> pos = _locate(key);
+    return _erase(_bucket(pos), pos.second, key);
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+std::pair<typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator, bool> bubble<T, _SIZE, Compare, Projection, Aggregate>::_insert_node(typename tree_type::node_handle& nh) {
+    std::pair<size_t, bool> pos = _locate(_proj(nh.value()));
+    if(pos.second) { return {const_iterator(this, pos.first), false}; }
+    if(this->_size == this->list.size() && this->list.size() < _SIZE) {
+        // pivots are stored by value, the node itself is dropped
+        this->list.insert(std::ranges::begin(this->list) + pos.first, {std::move(nh.value()), std::nullopt});
+        nh = typename tree_type::node_handle();
+        _size++;
+        _version++;
+        _pivots_changed();
+        return {const_iterator(this, pos.first), true};
+    }
+    size_t idx = _bucket(pos);
+    if(this->list[idx].second == std::nullopt) {
+        this->list[idx].second = tree_type();
+    }
+    auto result = this->list[idx].second.value().insert(std::move(nh));
+    nh = std::move(result.node);
+    if(result.inserted) {
+        _size++;
+        _bucket_changed(idx, 1);
+        _note_inserted(*result.position);
+        if(idx + 1 == this->list.size() && _spread_due()) {
+            // the new node may become the new pivot, its key is copied before the split
+            key_type key = _proj(*result.position);
+            _spread_last();
+            return {find(key), true};
         }
+    }
+    return {const_iterator(this, idx, result.position), result.inserted};
+}
 
-        auto it = std::lower_bound(std::ranges::begin(this->list), std::ranges::end(this->list), key, [](const std::pair<T, std::optional<avl_tree<T>>> &pair, const T &key){ return pair.first < key; });
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+std::pair<typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator, bool> bubble<T, _SIZE, Compare, Projection, Aggregate>::replace_min(const T& key) {
+    assert(this->_size > 0);
+    if(_compare(_proj(key), _proj(min())) == 0) { return {find(_proj(key)), false}; }
+    typename tree_type::node_handle evicted;
+    std::optional<tree_type>& first = this->list.front().second;
+    if(&min() != &this->list.front().first) {
+        evicted = first.value().extract_min();
+        _bucket_changed(0, -1);
+    }
+    else if(first != std::nullopt && first.value().size() > 0) {
+        // the pivot goes, the smallest tree key takes its place and its node is recycled
+        evicted = first.value().extract_min();
+        std::swap(evicted.value(), this->list.front().first);
+        _bucket_changed(0, -1);
+        _version++;
+        // when bucket 0 is the last one the recycled node may be the cached maximum
+        _cached_max.key = nullptr;
+    }
+    else {
+        T pivot = std::move(this->list.front().first);
+        this->list.erase(std::ranges::begin(this->list));
+        _size--;
+        _version++;
+        _pivots_changed();
+        auto result = insert(key);
+        if(!result.second) {
+            insert(pivot);
+            return {find(_proj(key)), false};
+        }
+        return result;
+    }
+    _cached_min.key = nullptr;
+    _size--;
 
-        if(it != std::ranges::end(this->list)) {
-            int idx = std::distance(std::ranges::begin(this->list), it);
-            if(this->list[idx].first == key) { return; }
+    T incoming = key;
+    std::swap(evicted.value(), incoming);
+    auto result = _insert_node(evicted);
+    if(!result.second) {
+        // key exists, the evicted key goes back into bucket 0
+        std::swap(evicted.value(), incoming);
+        _insert_node(evicted);
+        return {find(_proj(key)), false};
+    }
+    return result;
+}
 
-            if(idx == 0){
-                if(this->list[0].second == std::nullopt) {
-                    this->list[0].second = avl_tree<T>();
-                }
-                this->list[0].second.value().insert(key);
-            }
-            else{
-                if(this->list[idx - 1].second == std::nullopt) {
-                    this->list[idx - 1].second = avl_tree<T>();
-                }
-                this->list[idx - 1].second.value().insert(key);
-            }
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+size_t bubble<T, _SIZE, Compare, Projection, Aggregate>::_erase_range(const key_type* lo, const key_type* hi) {
+    if(this->_size == 0 || (lo && hi && _compare(*lo, *hi) >= 0)) { return 0; }
+    // buckets [first, last) hold keys of the range, the ones strictly between the two ends are
+    // covered completely
+    size_t first = lo ? _bucket(_locate(*lo)) : 0;
+    size_t last = this->list.size();
+    if(hi) {
+        std::pair<size_t, bool> pos = _locate(*hi);
+        last = pos.second ? std::max<size_t>(pos.first, 1) : _bucket(pos) + 1;
+    }
+    std::vector<bool> dropped(this->list.size(), false);
+    size_t removed = 0;
+    for(size_t i = first; i < last; i++) {
+        if(i != first && i + 1 != last) {
+            removed += _bucket_size(i);
+            dropped[i] = true;
+            continue;
         }
-        else {
-            if(this->list[this->list.size() - 1].second == std::nullopt){
-                this->list[this->list.size() - 1].second = avl_tree<T>();
-            }
-            this->list[this->list.size() - 1].second.value().insert(key);
+        auto& [pivot, tree] = this->list[i];
+        if(tree != std::nullopt) {
+            if(lo && hi) { removed += tree.value().erase(*lo, *hi); }
+            else if(lo) { removed += tree.value().erase_from(*lo); }
+            else { removed += tree.value().erase_below(*hi); }
         }
-        _size++;
-    };
-    (std::invoke(_insert, std::forward<Args>(keys)), ...);
-}
-
-
-template <typename T, size_t _SIZE>
-template <typename... Args>
-void bubble<T, _SIZE>::remove(Args ...keys) {
-    auto _remove = [&](const T&& key) -> void{
-        if(this->_size == 0) { return; }
-        if(this->_size <= _SIZE) {
-            auto [begin, end] = std::ranges::remove_if(this->list, [&](const std::pair<T, std::optional<avl_tree<T>>> &t) { return t.first == key; });
-            list.erase(begin, end);
-            _size--;
-        }
-        else{
-            auto it = std::lower_bound(std::ranges::begin(this->list), std::ranges::end(this->list), key, [](const std::pair<T, std::optional<avl_tree<T>>> &pair, const T &key){ return pair.first < key; });
-            if(it != std::ranges::end(this->list)) {
-                size_t idx = std::ranges::distance(std::ranges::begin(this->list), it);
-
-                if(this->list[idx].first == key && this->list[idx].second != std::nullopt) {
-                    T curr_root = this->list[idx].second.value().get_root();
-                    this->list[idx].second.value().remove(curr_root);
-                    this->list[idx].first = curr_root;
-                    return;
-                }
+        const key_type& key = _proj(pivot);
+        if((!lo || _compare(key, *lo) >= 0) && (!hi || _compare(key, *hi) < 0)) {
+            removed++;
+            dropped[i] = _drop_pivot(i);
+        }
+    }
+    if(removed == 0) { return 0; }
+    _size -= removed;
+    _version++;
+    _compact(dropped);
+    _pivots_changed();
+    return removed;
+}
 
-                if(idx == 0){
-                    if(this->list[0].second == std::nullopt){
-                        return;
-                    }
-                    this->list[0].second.value().remove(key);
-                }
-                else{
-                    if(this->list[idx - 1].second == std::nullopt) {
-                        return;
-                    }
-                    this->list[idx - 1].second.value().remove(key);
-                }
-            }
-            else {
-                if(this->list[this->list.size() - 1].second == std::nullopt) {
-                    return;
-                }
-                this->list[this->list.size() - 1].second.value().remove(key);
-            }
-            _size--;
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+bubble<T, _SIZE, Compare, Projection, Aggregate> bubble<T, _SIZE, Compare, Projection, Aggregate>::split(const key_type& key) {
+    bubble other;
+    if(this->_size == 0) { return other; }
+    std::pair<size_t, bool> pos = _locate(key);
+    // buckets [first, end) move as they are. The tree of the bucket in front of them may hold
+    // keys that move too, and the tree of bucket 0 may hold keys below its pivot that stay
+    size_t first = pos.first;
+    tree_type carried, kept;
+    if(first > 0 && !pos.second) {
+        std::optional<tree_type>& tree = this->list[first - 1].second;
+        if(tree != std::nullopt) { carried = tree.value().split(key); }
+    }
+    if(first == 0) {
+        std::optional<tree_type>& tree = this->list.front().second;
+        if(tree != std::nullopt) {
+            tree_type moved = tree.value().split(key);
+            kept = std::move(tree.value());
+            tree = std::move(moved);
+        }
+    }
+    other.list.assign(std::make_move_iterator(std::ranges::begin(this->list) + first), std::make_move_iterator(std::ranges::end(this->list)));
+    this->list.erase(std::ranges::begin(this->list) + first, std::ranges::end(this->list));
+    if(carried.size() > 0) {
+        T pivot = carried.pop_min();
+        other.list.insert(std::ranges::begin(other.list), {std::move(pivot), std::move(carried)});
+    }
+    if(kept.size() > 0) {
+        T pivot = kept.pop_min();
+        this->list.push_back({std::move(pivot), std::move(kept)});
+    }
+    for(size_t i = 0; i < other.list.size(); i++) {
+        other._size += other._bucket_size(i);
+    }
+    this->_size -= other._size;
+    _version++;
+    _pivots_changed();
+    return other;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+bubble<T, _SIZE, Compare, Projection, Aggregate> bubble<T, _SIZE, Compare, Projection, Aggregate>::_from_sorted(std::vector<T>&& keys, size_t buckets) {
+    bubble result;
+    if(keys.empty()) { return result; }
+    buckets = std::clamp<size_t>(buckets, 1, std::min(_SIZE, keys.size()));
+    for(size_t i = 0; i < buckets; i++) {
+        size_t first = keys.size() * i / buckets, last = keys.size() * (i + 1) / buckets;
+        std::optional<tree_type> tree;
+        if(last - first > 1) {
+            tree = tree_type::from_sorted(std::make_move_iterator(std::ranges::begin(keys) + first + 1), std::make_move_iterator(std::ranges::begin(keys) + last));
         }
+        result.list.push_back({std::move(keys[first]), std::move(tree)});
+    }
+    result._size = keys.size();
+    return result;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+template <typename Merge>
+bubble<T, _SIZE, Compare, Projection, Aggregate> bubble<T, _SIZE, Compare, Projection, Aggregate>::_set_operation(const bubble& a, const bubble& b, size_t threads, Merge merge) {
+    // a slice should be worth a thread and get at least one pivot of the result
+    constexpr size_t grain = 1 << 14;
+    const bubble& bigger = a.size() >= b.size() ? a : b;
+    size_t slices = std::clamp<size_t>(std::min({threads, bigger.size() / grain, _SIZE}), 1, _SIZE);
+
+    // the cuts are computed up front, the workers only read the two bubbles and never touch
+    // their lazily built summaries
+    std::vector<const_iterator> a_cuts{a.cbegin()}, b_cuts{b.cbegin()};
+    for(size_t i = 1; i < slices; i++) {
+        const key_type& key = _proj(*bigger.select(bigger.size() * i / slices));
+        a_cuts.push_back(a.lower_bound(key));
+        b_cuts.push_back(b.lower_bound(key));
+    }
+    a_cuts.push_back(a.cend());
+    b_cuts.push_back(b.cend());
+
+    auto less = [&a](const T& x, const T& y) { return a._compare(_proj(x), _proj(y)) < 0; };
+    auto slice = [&](size_t i) {
+        std::vector<T> keys;
+        merge(a_cuts[i], a_cuts[i + 1], b_cuts[i], b_cuts[i + 1], std::back_inserter(keys), less);
+        return _from_sorted(std::move(keys), _SIZE / slices);
     };
-    (std::invoke(_remove, std::forward<Args>(keys)), ...);
+    std::vector<std::future<bubble>> pending;
+    for(size_t i = 1; i < slices; i++) {
+        pending.push_back(std::async(std::launch::async, slice, i));
+    }
+    bubble result = slice(0);
+    for(auto && part : pending) {
+        result.concat(part.get());
+    }
+    return result;
 }
 
-template <typename T, size_t _SIZE>
-bool bubble<T, _SIZE>::search(const T& key) {
-    if(this->_size == 0) { return false; }
-    auto it = std::lower_bound(std::ranges::begin(this->list), std::ranges::end(this->list), key, [](const std::pair<T, std::optional<avl_tree<T>>> &pair, const T &key){ return pair.first < key; });
-    if (it != std::ranges::end(this->list)){
-        size_t idx = std::ranges::distance(std::ranges::begin(this->list), it);
-        if(idx == 0){
-            if(this->list[0].first == key) { return true; }
-            if(this->list[0].second == std::nullopt) { return false; }
-            if(this->list[0].second.value().search(key) == true) { return true; }
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+bubble<T, _SIZE, Compare, Projection, Aggregate> bubble<T, _SIZE, Compare, Projection, Aggregate>::set_union(const bubble& a, const bubble& b, size_t threads) {
+    return _set_operation(a, b, threads, [](auto... args) { std::set_union(args...); });
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+bubble<T, _SIZE, Compare, Projection, Aggregate> bubble<T, _SIZE, Compare, Projection, Aggregate>::set_intersection(const bubble& a, const bubble& b, size_t threads) {
+    return _set_operation(a, b, threads, [](auto... args) { std::set_intersection(args...); });
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+bubble<T, _SIZE, Compare, Projection, Aggregate> bubble<T, _SIZE, Compare, Projection, Aggregate>::set_difference(const bubble& a, const bubble& b, size_t threads) {
+    return _set_operation(a, b, threads, [](auto... args) { std::set_difference(args...); });
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+bool bubble<T, _SIZE, Compare, Projection, Aggregate>::concat(bubble&& other) {
+    if(other._size == 0) { return true; }
+    if(this->_size > 0) {
+        if(_compare(_proj(other.max()), _proj(min())) < 0) {
+            // other goes in front, swap the two so that it is always appended below
+            std::swap(this->list, other.list);
+            std::swap(this->_size, other._size);
+        }
+        else if(_compare(_proj(max()), _proj(other.min())) >= 0) {
+            return false;
+        }
+        auto& [pivot, tree] = other.list.front();
+        if(tree != std::nullopt && tree.value().size() > 0) {
+            // keys below the first pivot of other are bigger than every key here, so they belong
+            // to the tree of the last bucket
+            tree_type above = tree.value().split(_proj(pivot));
+            std::optional<tree_type>& last = this->list.back().second;
+            tree_type below = last ? std::move(last.value()) : tree_type();
+            last = tree_type::join(std::move(below), std::move(tree.value()));
+            tree = std::move(above);
+        }
+    }
+    this->list.insert(std::ranges::end(this->list), std::make_move_iterator(std::ranges::begin(other.list)), std::make_move_iterator(std::ranges::end(other.list)));
+    this->_size += other._size;
+    other.list.clear();
+    other._size = 0;
+    other._version++;
+    other._pivots_changed();
+    _merge_down(_SIZE);
+    _version++;
+    _pivots_changed();
+    return true;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+template <typename Pred>
+size_t bubble<T, _SIZE, Compare, Projection, Aggregate>::erase_if(Pred pred) {
+    std::vector<bool> dropped(this->list.size(), false);
+    size_t removed = 0;
+    for(size_t i = 0; i < this->list.size(); i++) {
+        auto& [pivot, tree] = this->list[i];
+        if(tree != std::nullopt) { removed += tree.value().erase_if(std::ref(pred)); }
+        if(std::invoke(pred, std::as_const(pivot))) {
+            removed++;
+            dropped[i] = _drop_pivot(i);
+        }
+    }
+    if(removed == 0) { return 0; }
+    _size -= removed;
+    _version++;
+    _compact(dropped);
+    _pivots_changed();
+    return removed;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+typename bubble<T, _SIZE, Compare, Projection, Aggregate>::node_type bubble<T, _SIZE, Compare, Projection, Aggregate>::extract(const key_type& key) {
+    if(this->_size == 0) { return node_type(); }
+    std::pair<size_t, bool> pos = _locate(key);
+    size_t idx = _bucket(pos);
+    std::optional<tree_type>& tree = this->list[idx].second;
+    if(!pos.second) { return _extract_tree(idx, key); }
+    _size--;
+    _version++;
+    if(_tree_size(tree) == 0) {
+        tree_type single;
+        single.insert(std::move(this->list[idx].first));
+        this->list.erase(std::ranges::begin(this->list) + idx);
+        _pivots_changed();
+        return single.extract_min();
+    }
+    // every key of the bucket is bigger than the new pivot, so the pivot array stays sorted
+    node_type nh = tree.value().extract_min();
+    std::swap(nh.value(), this->list[idx].first);
+    _bucket_changed(idx, -1);
+    _cached_min.key = nullptr;
+    _cached_max.key = nullptr;
+    return nh;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+typename bubble<T, _SIZE, Compare, Projection, Aggregate>::node_type bubble<T, _SIZE, Compare, Projection, Aggregate>::_extract_tree(size_t idx, const key_type& key) {
+    std::optional<tree_type>& tree = this->list[idx].second;
+    if(tree == std::nullopt) { return node_type(); }
+    node_type nh = tree.value().extract(key);
+    if(nh.empty()) { return nh; }
+    // the node keeps its address, but it is no longer part of the bubble
+    if(_cached_min.key == &nh.value()) { _cached_min.key = nullptr; }
+    if(_cached_max.key == &nh.value()) { _cached_max.key = nullptr; }
+    _size--;
+    _bucket_changed(idx, -1);
+    return nh;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+std::optional<T> bubble<T, _SIZE, Compare, Projection, Aggregate>::take(const key_type& key) {
+    if(this->_size == 0) { return std::nullopt; }
+    std::pair<size_t, bool> pos = _locate(key);
+    if(pos.second) {
+        T value = std::move(this->list[pos.first].first);
+        _erase(pos.first, true, _proj(value));
+        return value;
+    }
+    node_type nh = _extract_tree(_bucket(pos), key);
+    if(nh.empty()) { return std::nullopt; }
+    return std::move(nh.value());
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+void bubble<T, _SIZE, Compare, Projection, Aggregate>::merge(bubble& other) {
+    if(&other == this || other._size == 0) { return; }
+    if(this->_size == 0 || _compare(_proj(max()), _proj(other.min())) < 0 || _compare(_proj(other.max()), _proj(min())) < 0) {
+        concat(std::move(other));
+        return;
+    }
+    std::vector<std::pair<T, std::optional<tree_type>>> buckets = std::move(other.list);
+    other.list.clear();
+    other._size = 0;
+    other._version++;
+    other._pivots_changed();
+    for(auto && [pivot, tree] : buckets) {
+        if(!insert(pivot).second) { other.insert(pivot); }
+        while(_tree_size(tree) > 0) {
+            node_type nh = tree.value().extract_min();
+            if(!_insert_node(nh).second) { other._insert_node(nh); }
+        }
+    }
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+size_t bubble<T, _SIZE, Compare, Projection, Aggregate>::_erase(size_t idx, bool pivot, const key_type& key) {
+    std::optional<tree_type> &tree = this->list[idx].second;
+    if(pivot) {
+        if(tree == std::nullopt || tree.value().size() == 0) {
+            this->list.erase(std::ranges::begin(this->list) + idx);
+            _pivots_changed();
         }
         else {
-            if(this->list[idx].first == key) { return true; }
-            if(this->list[idx - 1].second == std::nullopt) { return false; }
-            if(this->list[idx - 1].second.value().search(key) == true) { return true; }
+            // every key of the bucket is bigger than the new pivot, so the pivot array stays sorted
+            this->list[idx].first = tree.value().pop_min();
+            _bucket_changed(idx, -1);
+            _cached_min.key = nullptr;
+            _cached_max.key = nullptr;
         }
+        _size--;
+        _version++;
+        return 1;
     }
-    else {
-        if(this->list[this->list.size() - 1].first == key) { return true; }
-        if(this->list[this->list.size() - 1].second == std::nullopt) { return false; }
-        if(this->list[this->list.size() - 1].second.value().search(key) == true) { return true; }
+    // the cached extremes point into the tree node that is about to be freed
+    bool was_min = idx == 0 && _cached_min.key && _compare(key, _proj(*_cached_min.key)) == 0;
+    bool was_max = idx + 1 == this->list.size() && _cached_max.key && _compare(key, _proj(*_cached_max.key)) == 0;
+    if(tree == std::nullopt || !tree.value().remove(key)) { return 0; }
+    if(was_min) { _cached_min.key = nullptr; }
+    if(was_max) { _cached_max.key = nullptr; }
+    _size--;
+    _bucket_changed(idx, -1);
+    return 1;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+bool bubble<T, _SIZE, Compare, Projection, Aggregate>::search(const key_type& key) const {
+    if(this->_size == 0) { return false; }
+    std::pair<size_t, bool> pos = _locate(key);
+    if(pos.second) { return true; }
+    size_t idx = _bucket(pos);
+    if(this->list[idx].second == std::nullopt) { return false; }
+    return this->list[idx].second.value().search(key);
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator bubble<T, _SIZE, Compare, Projection, Aggregate>::find_unshared(const key_type& key) {
+    if(this->_size == 0) { return cend(); }
+    std::pair<size_t, bool> pos = _locate(key);
+    size_t idx = _bucket(pos);
+    // pivots are copied with the bubble, only tree nodes are shared
+    if(pos.second) { return const_iterator(this, idx); }
+    if(this->list[idx].second == std::nullopt) { return cend(); }
+    tree_type& tree = this->list[idx].second.value();
+    auto it = tree.find_unshared(key);
+    if(it == tree.cend()) { return cend(); }
+    if(_shared.on) { _trees_written(); }
+    return const_iterator(this, idx, it);
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator bubble<T, _SIZE, Compare, Projection, Aggregate>::find(const key_type& key) const {
+    return find(cend(), key);
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator bubble<T, _SIZE, Compare, Projection, Aggregate>::find(const const_iterator& hint, const key_type& key) const {
+    if(this->_size == 0) { return cend(); }
+    bool valid = hint.b == this && hint.version == _version && hint.idx < this->list.size();
+    std::pair<size_t, bool> pos = valid ? _locate_near(hint.idx, key) : _locate(key);
+    size_t idx = _bucket(pos);
+    if(pos.second) { return const_iterator(this, idx); }
+    const tree_type* tree = _tree(idx);
+    if(tree == nullptr) { return cend(); }
+    auto it = valid && idx == hint.idx ? tree->find(hint.t, key) : tree->find(key);
+    return it == tree->cend() ? cend() : const_iterator(this, idx, it);
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator bubble<T, _SIZE, Compare, Projection, Aggregate>::lower_bound(const key_type& key) const {
+    if(this->list.empty()) { return cend(); }
+    std::pair<size_t, bool> pos = _locate(key);
+    if(pos.second) { return const_iterator(this, pos.first); }
+    size_t idx = _bucket(pos);
+    const tree_type* tree = _tree(idx);
+    if(pos.first == 0) {
+        // key is below the first pivot, the answer is a key of tree 0 below that pivot or the pivot
+        if(tree) {
+            auto it = tree->lower_bound(key);
+            if(it != tree->cend() && _compare(_proj(*it), _proj(this->list[0].first)) < 0) { return const_iterator(this, 0, it); }
+        }
+        return const_iterator(this, 0);
+    }
+    if(tree) {
+        auto it = tree->lower_bound(key);
+        if(it != tree->cend()) { return const_iterator(this, idx, it); }
+    }
+    const_iterator it(this);
+    if(idx + 1 < this->list.size()) { it.seek_first(idx + 1); }
+    return it;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+size_t bubble<T, _SIZE, Compare, Projection, Aggregate>::rank(const key_type& key) const {
+    if(this->list.empty()) { return 0; }
+    std::pair<size_t, bool> pos = _locate(key);
+    size_t idx = _bucket(pos);
+    const tree_type* tree = _tree(idx);
+    size_t in_tree = tree ? tree->rank(key) : 0;
+    if(pos.second) {
+        // only bucket 0 has tree keys below its pivot
+        return _count_prefix(idx) + (idx == 0 ? in_tree : 0);
     }
-    return false;
+    if(pos.first == 0) { return in_tree; }
+    return _count_prefix(idx) + 1 + in_tree;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator bubble<T, _SIZE, Compare, Projection, Aggregate>::select(size_t k) const {
+    if(k >= this->_size) { return cend(); }
+    auto [idx, j] = _count_search(k);
+    const tree_type* tree = _tree(idx);
+    size_t below = idx == 0 && tree ? tree->rank(_proj(this->list[0].first)) : 0;
+    if(j == below) { return const_iterator(this, idx); }
+    return const_iterator(this, idx, tree->select(j < below ? j : j - 1));
 }
 
-template <typename T, size_t _SIZE>
-T bubble<T, _SIZE>::get_key(const size_t &index) const {
-    assert(index >=0 && index < _SIZE);
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+typename bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator bubble<T, _SIZE, Compare, Projection, Aggregate>::cbegin() const noexcept {
+    const_iterator it(this);
+    if(!this->list.empty()) { it.seek_first(0); }
+    return it;
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+T bubble<T, _SIZE, Compare, Projection, Aggregate>::get_key(const size_t &index) const {
+    assert(index < this->list.size());
     return this->list[index].first;
 }
 
-template <typename T, size_t _SIZE>
-avl_tree<T> bubble<T, _SIZE>::get_tree(const size_t &index) const {
-    assert(index >=0 && index < _SIZE);
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+typename bubble<T, _SIZE, Compare, Projection, Aggregate>::tree_type bubble<T, _SIZE, Compare, Projection, Aggregate>::get_tree(const size_t &index) const {
+    assert(index < this->list.size());
     if(this->list[index].second == std::nullopt) {
-        return avl_tree<T>();
+        return tree_type();
     }
-    return avl_tree<T>(this->list[index].second.value());
+    _shared.on = true;
+    return tree_type(this->list[index].second.value());
 }
 
-template <typename T, size_t _SIZE>
-size_t bubble<T, _SIZE>::size() const {
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+size_t bubble<T, _SIZE, Compare, Projection, Aggregate>::size() const {
     return this->_size;
 }
 
-template <typename T, size_t _SIZE>
-bool bubble<T, _SIZE>::empty() const {
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+bool bubble<T, _SIZE, Compare, Projection, Aggregate>::empty() const {
     return this->_size == 0;
 }
 
-template <typename T, size_t _SIZE>
-size_t bubble<T, _SIZE>::array_size() const {
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+size_t bubble<T, _SIZE, Compare, Projection, Aggregate>::array_size() const {
     return _SIZE;
 }
 
-template <typename T, size_t _SIZE>
-class bubble<T, _SIZE>::iterator {
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+size_t bubble<T, _SIZE, Compare, Projection, Aggregate>::pivots() const {
+    return this->list.size();
+}
+
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+class bubble<T, _SIZE, Compare, Projection, Aggregate>::iterator {
 private:
-    using bubble = std::vector<std::pair<T, std::optional<avl_tree<T>>>>;
+    using bubble = std::vector<std::pair<T, std::optional<tree_type>>>;
     bubble b;
     int64_t index;
     size_t _size;
@@ -356,13 +1746,13 @@ public:
         this->_size = current.size();
         this->b= {};
         for(size_t i = 0; i<this->_size; i++){
-            this->b.push_back(std::pair<T, std::optional<avl_tree<T>>>(current.get_key(i), current.get_tree(i)));
+            this->b.push_back(std::pair<T, std::optional<tree_type>>(current.get_key(i), current.get_tree(i)));
         }
         return *(this);
     }
 
     iterator& operator++() {
-        if(this->index < _SIZE) {
+        if(this->index < static_cast<int64_t>(this->b.size())) {
             this->index++;
         }
         return *(this);
@@ -388,135 +1778,229 @@ public:
     }
 
     bool operator!=(const iterator &it) {
-        return it.b[it.index].first != this->b[this->index].first;
+        return it.index != this->index;
     }
 
     bool operator==(const iterator &it) {
-        return it.b[it.index].first == this->b[this->index].first;
+        return it.index == this->index;
     }
 
-    std::pair<T, std::optional<avl_tree<T>>>& operator*() {
+    std::pair<T, std::optional<tree_type>>& operator*() {
         return this->b[this->index];
     }
 };
 
 /**
-* @brief Non member functions
+* @brief const_iterator class, walks the keys in sorted order bucket by bucket. Inside a bucket
+* it steps through the tree with the tree's own iterator and merges the pivot in, which only
+* bucket 0 can have keys below. Any insertion or removal invalidates it, except for the iterator
+* that the operation returns
+*/
+template <typename T, size_t _SIZE, typename Compare, auto Projection, typename Aggregate>
+class bubble<T, _SIZE, Compare, Projection, Aggregate>::const_iterator {
+private:
+    using tree_iterator = typename tree_type::const_iterator;
+
+    const bubble* b{nullptr};
+    uint64_t version{0};
+    size_t idx{0};
+    // true when the iterator stands on the pivot of idx, t is then the first tree key after it
+    bool pivot{false};
+    tree_iterator t;
+
+    friend class bubble;
+
+    explicit const_iterator(const bubble* b) noexcept : b(b), version(b->_version), idx(b->list.size()) {}
+
+    explicit const_iterator(const bubble* b, size_t idx) : b(b), version(b->_version) { seek_pivot(idx); }
+
+    explicit const_iterator(const bubble* b, size_t idx, const tree_iterator& t) noexcept : b(b), version(b->_version), idx(idx), t(t) {}
+
+    const key_type& pivot_key() const { return _proj(b->list[idx].first); }
+
+    static bool at_end(const tree_iterator& it) { return it == tree_iterator(); }
+
+    void seek_pivot(size_t i) {
+        idx = i;
+        pivot = true;
+        const tree_type* tree = b->_tree(i);
+        if(tree == nullptr) { t = tree_iterator(); }
+        else { t = i == 0 ? tree->upper_bound(pivot_key()) : tree->cbegin(); }
+    }
+
+    void seek_first(size_t i) {
+        const tree_type* tree = b->_tree(i);
+        if(i == 0 && tree && tree->size() && b->_compare(_proj(*tree->first()), _proj(b->list[0].first)) < 0) {
+            idx = 0;
+            pivot = false;
+            t = tree->cbegin();
+            return;
+        }
+        seek_pivot(i);
+    }
+
+    void seek_last(size_t i) {
+        const tree_type* tree = b->_tree(i);
+        if(tree && tree->size() && b->_compare(_proj(*tree->last()), _proj(b->list[i].first)) > 0) {
+            idx = i;
+            pivot = false;
+            t = --tree->cend();
+            return;
+        }
+        seek_pivot(i);
+    }
+
+    void next() {
+        if(!pivot) {
+            const key_type& key = _proj(*t);
+            ++t;
+            if(idx == 0 && b->_compare(key, pivot_key()) < 0 && (at_end(t) || b->_compare(pivot_key(), _proj(*t)) < 0)) {
+                pivot = true;
+                return;
+            }
+        }
+        if(!at_end(t)) {
+            pivot = false;
+            return;
+        }
+        if(idx + 1 < b->list.size()) {
+            seek_first(idx + 1);
+            return;
+        }
+        *this = const_iterator(b);
+    }
+
+    void prev() {
+        if(idx == b->list.size()) {
+            if(idx > 0) { seek_last(idx - 1); }
+            return;
+        }
+        const tree_type* tree = b->_tree(idx);
+        if(pivot) {
+            // t is the first tree key after the pivot, anything before it is below the pivot
+            if(tree && t != tree->cbegin()) {
+                --t;
+                pivot = false;
+                return;
+            }
+        }
+        else if(t != tree->cbegin()) {
+            tree_iterator before = t;
+            --before;
+            if(b->_compare(pivot_key(), _proj(*t)) < 0 && b->_compare(_proj(*before), pivot_key()) < 0) { pivot = true; }
+            else { t = before; }
+            return;
+        }
+        else if(b->_compare(pivot_key(), _proj(*t)) < 0) {
+            pivot = true;
+            return;
+        }
+        if(idx > 0) { seek_last(idx - 1); }
+    }
+
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() noexcept = default;
+
+    reference operator*() const { return pivot ? b->list[idx].first : *t; }
+
+    pointer operator->() const { return &**this; }
+
+    const_iterator& operator++() {
+        next();
+        return *(this);
+    }
+
+    const_iterator operator++(int) {
+        const_iterator it = *(this);
+        ++*(this);
+        return it;
+    }
+
+    const_iterator& operator--() {
+        prev();
+        return *(this);
+    }
+
+    const_iterator operator--(int) {
+        const_iterator it = *(this);
+        --*(this);
+        return it;
+    }
+
+    bool operator==(const const_iterator& it) const { return idx == it.idx && pivot == it.pivot && (pivot || t == it.t); }
+
+    bool operator!=(const const_iterator& it) const { return !(*this == it); }
+};
+
+namespace bubble_detail {
+
+/**
+* @brief orders two buckets of the pivot array under Compare and Projection: by their pivots first, then
+* a bucket without a tree before one with a tree, then the trees lexicographically by their keys
+* @return std::partial_ordering: the order of a against b
 */
-template <typename T>
-bool operator==(const std::pair<T, std::optional<avl_tree<T>>> &a,
-                       const std::pair<T, std::optional<avl_tree<T>>> &b){
-                           if(a.first == b.first){
-                               if(a.second == std::nullopt && b.second == std::nullopt){
-                                   return true;
-                               }
-                               else if((a.second != std::nullopt && b.second == std::nullopt) || (a.second == std::nullopt && b.second != std::nullopt)){
-                                   return false;
-                               }
-                               else{
-                                   std::vector v1 { a.second.value().inorder() };
-                                   std::vector v2 { b.second.value().inorder() };
-                                   return v1 == v2;
-                               }
-                           }
-                           return false;
-}
-
-template <typename T>
-bool operator!=(const std::pair<T, std::optional<avl_tree<T>>> &a,
-                       const std::pair<T, std::optional<avl_tree<T>>> &b){
-                           if(a.first != b.first) { return true; }
-                           else {
-                               if(a.second == std::nullopt && b.second == std::nullopt) {
-                                   return false;
-                               }
-                               else if((a.second == std::nullopt && b.second != std::nullopt) || (a.second != std::nullopt && b.second == std::nullopt)){
-                                   return true;
-                               }
-                               else{
-                                   std::vector v1 { a.second.value().inorder() };
-                                   std::vector v2 { b.second.value().inorder() };
-                                   return v1 != v2;
-                               }
-                           }
-                           return false;
-}
-
-template <typename T>
-bool operator<(const std::pair<T, std::optional<avl_tree<T>>> &a,
-                    const std::pair<T, std::optional<avl_tree<T>>> &b){
-                        if(a.first == b.first) {
-                            if(a.second == std::nullopt && b.second != std::nullopt){
-                                return true;
-                            }
-                            else if(a.second != std::nullopt && b.second == std::nullopt){
-                                return false;
-                            }
-                            else{
-                                std::vector v1 { a.second.value().inorder() };
-                                std::vector v2 { b.second.value().inorder() };
-                                return v1 < v2;
-                            }
-                        }
-                        return a.first < b.first;
-}
-
-template <typename T>
-bool operator<=(const std::pair<T, std::optional<avl_tree<T>>> &a,
-                    const std::pair<T, std::optional<avl_tree<T>>> &b){
-                        if(a.first == b.first) {
-                            if(a.second == std::nullopt && b.second != std::nullopt){
-                                return true;
-                            }
-                            else if(a.second != std::nullopt && b.second == std::nullopt){
-                                return false;
-                            }
-                            else{
-                                std::vector v1 { a.second.value().inorder() };
-                                std::vector v2 { b.second.value().inorder() };
-                                return v1 <= v2;
-                            }
-                        }
-                        return a.first <= b.first;
-}
-
-template <typename T>
-bool operator>(const std::pair<T, std::optional<avl_tree<T>>> &a,
-                    const std::pair<T, std::optional<avl_tree<T>>> &b){
-                        if(a.first == b.first) {
-                            if(a.second == std::nullopt && b.second != std::nullopt){
-                                return false;
-                            }
-                            else if(a.second != std::nullopt && b.second == std::nullopt){
-                                return true;
-                            }
-                            else{
-                                std::vector v1 { a.second.value().inorder() };
-                                std::vector v2 { b.second.value().inorder() };
-                                return v1 > v2;
-                            }
-                        }
-                        return a.first > b.first;
-}
-
-
-template <typename T>
-bool operator>=(const std::pair<T, std::optional<avl_tree<T>>> &a,
-                    const std::pair<T, std::optional<avl_tree<T>>> &b){
-                        if(a.first == b.first) {
-                            if(a.second == std::nullopt && b.second != std::nullopt){
-                                return false;
-                            }
-                            else if(a.second != std::nullopt && b.second == std::nullopt){
-                                return true;
-                            }
-                            else{
-                                std::vector v1 { a.second.value().inorder() };
-                                std::vector v2 { b.second.value().inorder() };
-                                return v1 >= v2;
-                            }
-                        }
-                        return a.first >= b.first;
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+std::partial_ordering bucket_order(const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &a,
+                                   const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &b) {
+    const Compare comp{};
+    auto proj = [](const T& x) -> decltype(auto) { return std::invoke(Projection, x); };
+    std::partial_ordering c = three_way(comp, proj(a.first), proj(b.first));
+    if(c != 0) { return c; }
+    if(!a.second.has_value() || !b.second.has_value()) { return a.second.has_value() <=> b.second.has_value(); }
+    auto x = a.second->cbegin(), y = b.second->cbegin();
+    const auto x_end = a.second->cend(), y_end = b.second->cend();
+    for(; x != x_end && y != y_end; ++x, ++y) {
+        c = three_way(comp, proj(*x), proj(*y));
+        if(c != 0) { return c; }
+    }
+    return (x != x_end) <=> (y != y_end);
+}
+
+} // namespace bubble_detail
+
+/**
+* @brief Non member functions, buckets compare through bubble_detail::bucket_order
+*/
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+bool operator==(const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &a,
+                const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &b) {
+    return bubble_detail::bucket_order(a, b) == 0;
+}
+
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+bool operator!=(const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &a,
+                const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &b) {
+    return !(a == b);
+}
+
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+bool operator<(const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &a,
+               const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &b) {
+    return bubble_detail::bucket_order(a, b) < 0;
+}
+
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+bool operator<=(const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &a,
+                const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &b) {
+    return bubble_detail::bucket_order(a, b) <= 0;
+}
+
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+bool operator>(const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &a,
+               const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &b) {
+    return bubble_detail::bucket_order(a, b) > 0;
+}
+
+template <typename T, typename Compare, auto Projection, typename Aggregate>
+bool operator>=(const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &a,
+                const std::pair<T, std::optional<avl_tree<T, Compare, Projection, Aggregate>>> &b) {
+    return bubble_detail::bucket_order(a, b) >= 0;
 }
 
 #endif
@@ -0,0 +1,159 @@
+/**
+* @brief Implementation of the bubble_map data structure, a key-value container built on the same
+* pivot array and avl_trees as bubble. Only the keys live inside the bubble, every key is stored next to
+* the index of its value in a separate contiguous store, so descending the pivots and the trees only
+* ever touches keys and the values stay packed together
+*/
+
+#ifndef BUBBLE_MAP_H
+#define BUBBLE_MAP_H
+
+#ifdef __cplusplus
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "bubble.h"
+#endif
+
+/**
+* @brief implementation of bubble_map<K, V, SIZE, Compare>
+*/
+template <typename K, typename V, size_t _SIZE, typename Compare = std::less<>>
+class bubble_map {
+private:
+    /**
+    * @brief what the bubble stores, the key and the slot of its value in values. The slot is
+    * not part of the ordering so it can be set through a const_iterator
+    */
+    struct entry {
+        K key;
+        mutable size_t slot;
+    };
+
+    bubble<entry, _SIZE, Compare, &entry::key> index;
+    std::vector<std::optional<V>> values;
+    std::vector<size_t> free_slots;
+
+    template <typename... Args>
+    size_t _allocate(Args&& ...args) {
+        if(!this->free_slots.empty()) {
+            size_t slot = this->free_slots.back();
+            this->free_slots.pop_back();
+            this->values[slot].emplace(std::forward<Args>(args)...);
+            return slot;
+        }
+        this->values.emplace_back(std::in_place, std::forward<Args>(args)...);
+        return this->values.size() - 1;
+    }
+
+public:
+    /**
+    * @brief default constructor of bubble_map
+    */
+    explicit bubble_map() noexcept = default;
+
+    /**
+    * @brief find function for bubble_map
+    * @param key: the key you want to find
+    * @return V*: pointer to the mapped value or nullptr if key does not exist. The pointer is
+    * invalidated by the next insertion, like a pointer to an element of std::vector
+    */
+    V* find(const K& key) {
+        auto it = this->index.find(key);
+        return it == this->index.cend() ? nullptr : &this->values[it->slot].value();
+    }
+
+    const V* find(const K& key) const {
+        auto it = this->index.find(key);
+        return it == this->index.cend() ? nullptr : &this->values[it->slot].value();
+    }
+
+    /**
+    * @brief contains function for bubble_map
+    * @return true: if key exists in the bubble_map
+    * @return false: otherwise
+    */
+    bool contains(const K& key) const { return this->index.search(key); }
+
+    /**
+    * @brief try_emplace function for bubble_map
+    * @param key: the key you want to insert
+    * @param args: the arguments the value is constructed from, only used if key does not exist
+    * @return std::pair<V*, bool>: the mapped value and true if it was inserted
+    */
+    template <typename... Args>
+    std::pair<V*, bool> try_emplace(const K& key, Args&& ...args) {
+        auto [it, inserted] = this->index.find_or_insert(key, [&]() { return entry{key, 0}; });
+        if(inserted) {
+            try {
+                it->slot = _allocate(std::forward<Args>(args)...);
+            }
+            catch (...) {
+                this->index.remove(key);
+                throw;
+            }
+        }
+        return {&this->values[it->slot].value(), inserted};
+    }
+
+    /**
+    * @brief insert_or_assign function for bubble_map
+    * @param key: the key you want to insert
+    * @param value: the value that is assigned to key
+    * @return std::pair<V*, bool>: the mapped value and true if key did not exist
+    */
+    template <typename M>
+    std::pair<V*, bool> insert_or_assign(const K& key, M&& value) {
+        auto [it, inserted] = this->index.find_or_insert(key, [&]() { return entry{key, 0}; });
+        if(inserted) {
+            try {
+                it->slot = _allocate(std::forward<M>(value));
+            }
+            catch (...) {
+                this->index.remove(key);
+                throw;
+            }
+            return {&this->values[it->slot].value(), true};
+        }
+        V& found = this->values[it->slot].value();
+        found = std::forward<M>(value);
+        return {&found, false};
+    }
+
+    /**
+    * @brief operator [] for bubble_map
+    * @param key: the key you want to access, a default constructed value is inserted if it does not exist
+    * @return V&: the mapped value
+    */
+    V& operator[](const K& key) { return *try_emplace(key).first; }
+
+    /**
+    * @brief erase function for bubble_map
+    * @param key: the key you want to remove
+    * @return size_t: the number of removed keys
+    */
+    size_t erase(const K& key) {
+        std::optional<entry> e = this->index.take(key);
+        if(!e) { return 0; }
+        size_t slot = e->slot;
+        this->values[slot].reset();
+        this->free_slots.push_back(slot);
+        return 1;
+    }
+
+    /**
+    * @brief size function for bubble_map
+    * @return size_t: the number of keys
+    */
+    size_t size() const { return this->index.size(); }
+
+    /**
+    * @brief empty function for bubble_map
+    * @return true: if bubble_map is empty
+    * @return false: otherwise
+    */
+    bool empty() const { return this->index.empty(); }
+};
+
+#endif
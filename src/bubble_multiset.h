@@ -0,0 +1,125 @@
+/**
+* @brief Implementation of the bubble_multiset data structure, the counted version of bubble.
+* Every distinct key is stored once next to the number of its occurrences, so inserting a key that
+* already exists only increments its count in place and never allocates a new node
+*/
+
+#ifndef BUBBLE_MULTISET_H
+#define BUBBLE_MULTISET_H
+
+#ifdef __cplusplus
+#include <functional>
+#include "bubble.h"
+#endif
+
+/**
+* @brief implementation of bubble_multiset<T, SIZE, Compare, Projection>
+*/
+template <typename T, size_t _SIZE, typename Compare = std::less<>, auto Projection = std::identity{}>
+class bubble_multiset {
+private:
+    /**
+    * @brief what the bubble stores, the key and its occurrences. The count is not part of
+    * the ordering so it can be changed in place through a const_iterator
+    */
+    struct entry {
+        T key;
+        mutable size_t count;
+    };
+
+    /**
+    * @brief projects an entry to the key of its stored T
+    */
+    struct entry_key {
+        decltype(auto) operator()(const entry& e) const { return std::invoke(Projection, e.key); }
+    };
+
+    bubble<entry, _SIZE, Compare, entry_key{}> index;
+    size_t _size{0};
+
+public:
+    using key_type = typename bubble<entry, _SIZE, Compare, entry_key{}>::key_type;
+
+    /**
+    * @brief default constructor of bubble_multiset
+    */
+    explicit bubble_multiset() noexcept = default;
+
+    /**
+    * @brief insert function for bubble_multiset
+    * @param key: the key you want to insert
+    * @return size_t: the occurrences of key after the insertion
+    */
+    size_t insert(const T& key) {
+        // the count changes in place, so the entry must not be shared with a copy of this multiset
+        auto it = this->index.find_or_insert_unshared(std::invoke(Projection, key), [&]() { return entry{key, 0}; }).first;
+        // counted only once the entry exists, a throwing copy of key leaves the size alone
+        _size++;
+        return ++it->count;
+    }
+
+    /**
+    * @brief count function for bubble_multiset
+    * @param key: the key you want to count
+    * @return size_t: the occurrences of key
+    */
+    size_t count(const key_type& key) const {
+        auto it = this->index.find(key);
+        return it == this->index.cend() ? 0 : it->count;
+    }
+
+    /**
+    * @brief erase_one function for bubble_multiset, removes a single occurrence of key
+    * @param key: the key you want to remove
+    * @return true: if key existed
+    * @return false: otherwise
+    */
+    bool erase_one(const key_type& key) {
+        // the count changes in place, so the entry must not be shared with a copy of this multiset
+        auto it = this->index.find_unshared(key);
+        if(it == this->index.cend()) { return false; }
+        _size--;
+        if(--it->count == 0) { this->index.remove(key); }
+        return true;
+    }
+
+    /**
+    * @brief erase function for bubble_multiset, removes every occurrence of key
+    * @param key: the key you want to remove
+    * @return size_t: the number of removed occurrences
+    */
+    size_t erase(const key_type& key) {
+        std::optional<entry> e = this->index.take(key);
+        if(!e) { return 0; }
+        _size -= e->count;
+        return e->count;
+    }
+
+    /**
+    * @brief contains function for bubble_multiset
+    * @return true: if key occurs at least once
+    * @return false: otherwise
+    */
+    bool contains(const key_type& key) const { return this->index.search(key); }
+
+    /**
+    * @brief size function for bubble_multiset
+    * @return size_t: the number of occurrences of every key
+    */
+    size_t size() const { return this->_size; }
+
+    /**
+    * @brief distinct function for bubble_multiset
+    * @return size_t: the number of distinct keys
+    */
+    size_t distinct() const { return this->index.size(); }
+
+    /**
+    * @brief empty function for bubble_multiset
+    * @return true: if bubble_multiset is empty
+    * @return false: otherwise
+    */
+    bool empty() const { return this->_size == 0; }
+};
+
+#endif
@@ -0,0 +1,144 @@
+/**
+* @brief Implementation of the bubble_mvcc data structure, a bubble that long running scans read while
+* writers keep changing it. A scan pins the current version and sees the keys of that moment for as
+* long as it holds the pin. Writers never wait for a scan, they copy the tree paths that a pinned
+* version still shares, and a version is freed together with the last pin that refers to it
+*/
+
+#ifndef BUBBLE_MVCC_H
+#define BUBBLE_MVCC_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include "bubble.h"
+#endif
+
+/**
+* @brief implementation of bubble_mvcc<T, SIZE, Compare, Projection, Aggregate>
+*/
+template <typename T, size_t _SIZE, typename Compare = std::less<>, auto Projection = std::identity{}, typename Aggregate = no_aggregate>
+class bubble_mvcc {
+public:
+    using bubble_type = bubble<T, _SIZE, Compare, Projection, Aggregate>;
+    using key_type = typename bubble_type::key_type;
+
+    /**
+    * @brief a pinned version. It owns a snapshot of the bubble, so reading it takes no lock and
+    * later writes never show up in it
+    */
+    class version {
+    public:
+        /**
+        * @brief epoch function
+        * @return uint64_t: the number of writes that happened before the version was pinned
+        */
+        uint64_t epoch() const noexcept { return this->_epoch; }
+
+        /**
+        * @brief access to the keys of the version, every const member of bubble can be used
+        */
+        const bubble_type& operator*() const noexcept { return this->_keys; }
+        const bubble_type* operator->() const noexcept { return &this->_keys; }
+
+    private:
+        friend class bubble_mvcc;
+
+        version(uint64_t epoch, bubble_type&& keys) noexcept : _epoch(epoch), _keys(std::move(keys)) {}
+
+        uint64_t _epoch;
+        bubble_type _keys;
+    };
+
+private:
+    // serializes the writers and the pins, a pin copies the pivot array of _current
+    mutable std::mutex _writer;
+    bubble_type _current;
+    uint64_t _epoch{0};
+
+public:
+    /**
+    * @brief default constructor of bubble_mvcc
+    */
+    explicit bubble_mvcc() noexcept = default;
+
+    /**
+    * @brief pin function for bubble_mvcc, O(SIZE) no matter how many keys are stored. Hand each
+    * reader thread its own version, the keys stay alive until the version is destroyed
+    * @return version: the current keys
+    */
+    version pin() const {
+        std::lock_guard<std::mutex> lock(this->_writer);
+        return version(this->_epoch, this->_current.snapshot());
+    }
+
+    /**
+    * @brief insert function for bubble_mvcc
+    * @param key: the key you want to insert
+    * @return true: if key was inserted
+    * @return false: if key already exists
+    */
+    bool insert(const T& key) {
+        std::lock_guard<std::mutex> lock(this->_writer);
+        bool inserted = this->_current.insert(key).second;
+        this->_epoch += inserted;
+        return inserted;
+    }
+
+    /**
+    * @brief remove function for bubble_mvcc
+    * @param key: the key you want to remove
+    * @return size_t: the number of removed keys
+    */
+    size_t remove(const key_type& key) {
+        std::lock_guard<std::mutex> lock(this->_writer);
+        size_t removed = this->_current.remove(key);
+        this->_epoch += removed;
+        return removed;
+    }
+
+    /**
+    * @brief write function for bubble_mvcc, runs f on the current bubble as a single write, so a
+    * version sees all of its changes or none of them
+    * @param f: called with bubble_type&, it must not keep the reference
+    * @return whatever f returns
+    */
+    template <typename F>
+    decltype(auto) write(F&& f) {
+        std::lock_guard<std::mutex> lock(this->_writer);
+        this->_epoch++;
+        return std::invoke(std::forward<F>(f), this->_current);
+    }
+
+    /**
+    * @brief contains function for bubble_mvcc, reads the current version
+    * @return true: if key exists
+    * @return false: otherwise
+    */
+    bool contains(const key_type& key) const {
+        std::lock_guard<std::mutex> lock(this->_writer);
+        return this->_current.search(key);
+    }
+
+    /**
+    * @brief size function for bubble_mvcc
+    * @return size_t: the number of keys of the current version
+    */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(this->_writer);
+        return this->_current.size();
+    }
+
+    /**
+    * @brief epoch function for bubble_mvcc
+    * @return uint64_t: the number of writes so far, the epoch the next pin gets
+    */
+    uint64_t epoch() const {
+        std::lock_guard<std::mutex> lock(this->_writer);
+        return this->_epoch;
+    }
+};
+
+#endif
@@ -0,0 +1,100 @@
+/**
+* @brief Implementation of the bubble_top_n data structure, a bubble with a capacity that keeps the
+* biggest keys it has seen. Once it is full a key that is not bigger than the current minimum is
+* rejected after a single comparison against the cached minimum, any other key evicts that minimum
+* and reuses its tree node, so a full bubble_top_n neither searches for the victim nor allocates
+*/
+
+#ifndef BUBBLE_TOP_N_H
+#define BUBBLE_TOP_N_H
+
+#ifdef __cplusplus
+#include <functional>
+#include "bubble.h"
+#endif
+
+/**
+* @brief implementation of bubble_top_n<T, SIZE, Compare, Projection>. Compare orders the keys like
+* in bubble and the biggest ones are kept, so bubble_top_n<T, SIZE, std::greater<>> keeps the
+* smallest keys and evicts the biggest
+*/
+template <typename T, size_t _SIZE, typename Compare = std::less<>, auto Projection = std::identity{}>
+class bubble_top_n {
+private:
+    using index_type = bubble<T, _SIZE, Compare, Projection>;
+
+    index_type index;
+    size_t _capacity;
+
+public:
+    using key_type = typename index_type::key_type;
+    using const_iterator = typename index_type::const_iterator;
+
+    /**
+    * @brief constructor of bubble_top_n
+    * @param capacity: the maximum number of keys, it must be bigger than 0
+    */
+    explicit bubble_top_n(size_t capacity) noexcept : _capacity(capacity) { assert(capacity > 0); }
+
+    /**
+    * @brief insert function for bubble_top_n
+    * @param key: the key you want to insert
+    * @return true: if key was inserted, possibly evicting the current minimum
+    * @return false: if key already exists or the bubble_top_n is full and key is not bigger than
+    * the current minimum
+    */
+    bool insert(const T& key) {
+        if(this->index.size() < this->_capacity) { return this->index.insert(key).second; }
+        const T& threshold = this->index.min();
+        if(bubble_detail::three_way(Compare{}, std::invoke(Projection, key), std::invoke(Projection, threshold)) <= 0) {
+            return false;
+        }
+        return this->index.replace_min(key).second;
+    }
+
+    /**
+    * @brief min function for bubble_top_n, the key that the next accepted key evicts once full
+    * @return const T&: the smallest kept key, the bubble_top_n must not be empty
+    */
+    const T& min() const { return this->index.min(); }
+
+    /**
+    * @brief max function for bubble_top_n
+    * @return const T&: the biggest kept key, the bubble_top_n must not be empty
+    */
+    const T& max() const { return this->index.max(); }
+
+    /**
+    * @brief contains function for bubble_top_n
+    * @return true: if key is kept
+    * @return false: otherwise
+    */
+    bool contains(const key_type& key) const { return this->index.search(key); }
+
+    /**
+    * @brief size function for bubble_top_n
+    * @return size_t: the number of kept keys
+    */
+    size_t size() const { return this->index.size(); }
+
+    /**
+    * @brief capacity function for bubble_top_n
+    * @return size_t: the maximum number of kept keys
+    */
+    size_t capacity() const { return this->_capacity; }
+
+    /**
+    * @brief empty function for bubble_top_n
+    * @return true: if bubble_top_n is empty
+    * @return false: otherwise
+    */
+    bool empty() const { return this->index.empty(); }
+
+    /**
+    * @brief iterators over the kept keys in sorted order, smallest first
+    */
+    const_iterator cbegin() const { return this->index.cbegin(); }
+    const_iterator cend() const { return this->index.cend(); }
+};
+
+#endif
@@ -0,0 +1,540 @@
+/**
+* @brief Implementation of the concurrent_bubble data structure, a bubble that many threads use at
+* once. The pivot array is published through an atomic pointer and never changes once it is
+* published, a new pivot array replaces it as a whole. The keys between two pivots live in a bucket
+* that is chosen at compile time: cow_avl_bucket locks only the bucket a writer changes and
+* publishes copied paths, combining_avl_bucket lets one writer apply the waiting writes of a bucket
+* in a single batch, lockfree_skiplist lets writers of the same bucket run without locks.
+* Readers take no lock and write no shared memory, what they might still read is freed by epoch
+* based reclamation
+*/
+
+#ifndef CONCURRENT_BUBBLE_H
+#define CONCURRENT_BUBBLE_H
+
+#ifdef __cplusplus
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "bubble.h"
+#include "epoch.h"
+#include "lockfree_skiplist.h"
+#endif
+
+/**
+* @brief the default bucket of concurrent_bubble. Writers take the mutex of the bucket, copy the
+* tree, which shares every node with the published one, change the copy and publish it with a
+* single pointer store. Readers take no lock
+*/
+template <typename T, typename Compare = std::less<>, auto Projection = std::identity{}>
+class cow_avl_bucket {
+public:
+    using tree_type = avl_tree<T, Compare, Projection>;
+    using key_type = typename tree_type::key_type;
+
+protected:
+    std::mutex _writer;
+    // never changed once it is published, null stands for an empty tree
+    std::atomic<const tree_type*> _tree{nullptr};
+
+    static decltype(auto) _proj(const T& x) { return std::invoke(Projection, x); }
+
+    /**
+    * @brief publishes the tree that write produces from a copy of the current one, so the write
+    * copies its path instead of changing nodes that readers may be walking. _writer must be held
+    */
+    template <typename F>
+    void _publish(F&& write) {
+        const tree_type* current = this->_tree.load(std::memory_order_relaxed);
+        tree_type* next = current ? new tree_type(*current) : new tree_type();
+        write(*next);
+        this->_tree.store(next, std::memory_order_release);
+        if(current) { bubble_detail::epoch_domain::instance().retire(current); }
+    }
+
+public:
+    /**
+    * @brief default constructor of cow_avl_bucket
+    */
+    explicit cow_avl_bucket() noexcept = default;
+
+    /**
+    * @brief destructor of cow_avl_bucket, no other thread may use it anymore
+    */
+    ~cow_avl_bucket() { delete this->_tree.load(std::memory_order_relaxed); }
+
+    cow_avl_bucket(const cow_avl_bucket&) = delete;
+    cow_avl_bucket& operator=(const cow_avl_bucket&) = delete;
+
+    /**
+    * @brief adopt function for cow_avl_bucket, takes over t in O(1). The bucket must be empty and
+    * no other thread may use it yet
+    */
+    void adopt(tree_type&& t) { this->_tree.store(new tree_type(std::move(t)), std::memory_order_release); }
+
+    /**
+    * @brief fill function for cow_avl_bucket, builds the tree from strictly increasing keys in
+    * O(n). The bucket must be empty and no other thread may use it yet
+    */
+    template <std::input_iterator It>
+    void fill(It first, It last) {
+        if(first != last) { adopt(tree_type::from_sorted(first, last)); }
+    }
+
+    /**
+    * @brief insert function for cow_avl_bucket, safe to call from any thread
+    * @return true: if key was inserted
+    * @return false: if key already exists
+    */
+    bool insert(const T& key) {
+        std::lock_guard<std::mutex> lock(this->_writer);
+        const tree_type* current = this->_tree.load(std::memory_order_relaxed);
+        if(current && current->search(_proj(key))) { return false; }
+        _publish([&](tree_type& t) { t.insert(key); });
+        return true;
+    }
+
+    /**
+    * @brief remove function for cow_avl_bucket, safe to call from any thread
+    * @return size_t: the number of removed keys
+    */
+    size_t remove(const key_type& key) {
+        std::lock_guard<std::mutex> lock(this->_writer);
+        const tree_type* current = this->_tree.load(std::memory_order_relaxed);
+        if(!current || !current->search(key)) { return 0; }
+        _publish([&](tree_type& t) { t.remove(key); });
+        return 1;
+    }
+
+    /**
+    * @brief search function for cow_avl_bucket, safe to call from any thread
+    * @return true: if key exists
+    * @return false: otherwise
+    */
+    bool search(const key_type& key) const {
+        bubble_detail::epoch_domain::guard reading;
+        const tree_type* t = this->_tree.load(std::memory_order_acquire);
+        return t && t->search(key);
+    }
+
+    /**
+    * @brief for_each function for cow_avl_bucket, visits the keys of the tree that is published
+    * when it starts in sorted order
+    * @param f: called with const T& for every key
+    */
+    template <typename F>
+    void for_each(F&& f) const {
+        bubble_detail::epoch_domain::guard reading;
+        const tree_type* t = this->_tree.load(std::memory_order_acquire);
+        if(t == nullptr) { return; }
+        for(auto it = t->cbegin(); it != t->cend(); ++it) { std::invoke(f, *it); }
+    }
+};
+
+/**
+* @brief a cow_avl_bucket whose writers combine. A writer posts its request in a slot of the bucket
+* and whoever gets the mutex applies every posted request in one sorted batch: the tree is copied
+* once, the paths are copied once per batch instead of once per write and every search starts from
+* the previous key. The others only wait for their result, so a hot bucket hands the mutex over once
+* per batch instead of once per write
+*/
+template <typename T, typename Compare = std::less<>, auto Projection = std::identity{}>
+class combining_avl_bucket : public cow_avl_bucket<T, Compare, Projection> {
+public:
+    using tree_type = typename cow_avl_bucket<T, Compare, Projection>::tree_type;
+    using key_type = typename tree_type::key_type;
+    static constexpr size_t slots = 8;
+
+private:
+    enum _state : int { _free, _claimed, _posted, _done };
+
+    struct alignas(64) _request {
+        std::atomic<int> state{_free};
+        const T* value;
+        // the key of value for an insertion, it lives on the stack of the waiting writer
+        const key_type* key;
+        bool result;
+    };
+
+    _request _requests[slots];
+    [[no_unique_address]] Compare comp{};
+
+    auto _compare(const key_type& a, const key_type& b) const { return bubble_detail::three_way(comp, a, b); }
+
+    /**
+    * @brief applies every posted request and mine, if any, as one write. _writer must be held
+    */
+    void _combine(_request* mine) {
+        std::array<_request*, slots + 1> batch;
+        size_t n = 0;
+        for(auto && r : this->_requests) {
+            if(r.state.load(std::memory_order_acquire) == _posted) { batch[n++] = &r; }
+        }
+        if(mine != nullptr) { batch[n++] = mine; }
+        if(n == 0) { return; }
+        // an insertion sort, a batch holds at most slots + 1 requests
+        for(size_t i = 1; i < n; i++) {
+            _request* r = batch[i];
+            size_t j = i;
+            for(; j > 0 && _compare(*r->key, *batch[j - 1]->key) < 0; j--) { batch[j] = batch[j - 1]; }
+            batch[j] = r;
+        }
+        const tree_type* current = this->_tree.load(std::memory_order_relaxed);
+        tree_type next = current ? tree_type(*current) : tree_type();
+        bool changed = false;
+        typename tree_type::const_iterator hint = next.cend();
+        for(size_t i = 0; i < n; i++) {
+            _request& r = *batch[i];
+            auto it = next.find(hint, *r.key);
+            if(r.value != nullptr) {
+                r.result = it == next.cend();
+                hint = r.result ? next.insert(hint, *r.value).first : it;
+            }
+            else {
+                r.result = it != next.cend();
+                if(r.result) {
+                    next.remove(*r.key);
+                    hint = next.cend();
+                }
+            }
+            changed = changed || r.result;
+        }
+        if(changed) {
+            this->_tree.store(new tree_type(std::move(next)), std::memory_order_release);
+            if(current) { bubble_detail::epoch_domain::instance().retire(current); }
+        }
+        for(size_t i = 0; i < n; i++) {
+            if(batch[i] != mine) { batch[i]->state.store(_done, std::memory_order_release); }
+        }
+    }
+
+    /**
+    * @brief posts a request and waits until some writer applied it, a writer that finds every slot
+    * taken applies its request itself
+    */
+    bool _write(const T* value, const key_type& key) {
+        thread_local const size_t home = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        _request* r = nullptr;
+        for(size_t i = 0; i < slots && r == nullptr; i++) {
+            _request& s = this->_requests[(home + i) % slots];
+            int expected = _free;
+            if(s.state.load(std::memory_order_relaxed) == _free && s.state.compare_exchange_strong(expected, _claimed, std::memory_order_acquire)) { r = &s; }
+        }
+        if(r == nullptr) {
+            _request mine;
+            mine.value = value;
+            mine.key = &key;
+            std::lock_guard<std::mutex> lock(this->_writer);
+            _combine(&mine);
+            return mine.result;
+        }
+        r->value = value;
+        r->key = &key;
+        r->state.store(_posted, std::memory_order_release);
+        while(r->state.load(std::memory_order_acquire) != _done) {
+            if(this->_writer.try_lock()) {
+                _combine(nullptr);
+                this->_writer.unlock();
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+        bool result = r->result;
+        r->state.store(_free, std::memory_order_release);
+        return result;
+    }
+
+public:
+    /**
+    * @brief insert function for combining_avl_bucket, safe to call from any thread
+    * @return true: if key was inserted
+    * @return false: if key already exists
+    */
+    bool insert(const T& key) {
+        const key_type& k = std::invoke(Projection, key);
+        return _write(&key, k);
+    }
+
+    /**
+    * @brief remove function for combining_avl_bucket, safe to call from any thread
+    * @return size_t: the number of removed keys
+    */
+    size_t remove(const key_type& key) { return _write(nullptr, key); }
+};
+
+/**
+* @brief implementation of concurrent_bubble<T, SIZE, Compare, Projection, Bucket>. Bucket is
+* cow_avl_bucket, combining_avl_bucket or lockfree_skiplist, or any class template with the same
+* members
+*/
+template <typename T, size_t _SIZE, typename Compare = std::less<>, auto Projection = std::identity{}, template <typename, typename, auto> class Bucket = cow_avl_bucket>
+class concurrent_bubble {
+public:
+    using tree_type = avl_tree<T, Compare, Projection>;
+    using bucket_type = Bucket<T, Compare, Projection>;
+    using key_type = typename tree_type::key_type;
+
+private:
+    /**
+    * @brief the part of a bucket that changes between two pivot arrays. A removed pivot stays
+    * in the pivot array as a boundary and is only marked as absent, so removing it never moves
+    * the other buckets. Every bucket sits on its own cache line
+    */
+    struct alignas(64) _bucket {
+        std::atomic<bool> present{true};
+        bucket_type keys;
+    };
+
+    /**
+    * @brief a published pivot array with its buckets, bucket i holds pivot i and the keys up to
+    * the next pivot, bucket 0 also the keys below pivot 0. It is replaced as a whole
+    */
+    struct _layout {
+        std::vector<T> pivots;
+        std::unique_ptr<_bucket[]> buckets;
+
+        explicit _layout(std::vector<T>&& p) : pivots(std::move(p)), buckets(new _bucket[pivots.size()]) {}
+    };
+
+    std::atomic<const _layout*> _current;
+    // taken shared by writers of a single bucket and exclusive by writers that publish a new
+    // layout, readers never take it
+    std::shared_mutex _restructure;
+    // the pivots are final, new keys go into the trees. Guarded by _restructure
+    bool _frozen{false};
+    std::atomic<size_t> _size{0};
+    [[no_unique_address]] Compare comp{};
+
+    static decltype(auto) _proj(const T& x) { return std::invoke(Projection, x); }
+
+    auto _compare(const key_type& a, const key_type& b) const { return bubble_detail::three_way(comp, a, b); }
+
+    /**
+    * @brief binary search over the pivots of l, like bubble::_locate
+    * @return std::pair<size_t, bool>: the index of the matching pivot and true, or the number of
+    * pivots that are smaller than key and false
+    */
+    std::pair<size_t, bool> _locate(const _layout& l, const key_type& key) const {
+        size_t lo = 0, hi = l.pivots.size();
+        while(lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            auto c = _compare(key, _proj(l.pivots[mid]));
+            if(c == 0) { return {mid, true}; }
+            if(c < 0) { hi = mid; }
+            else { lo = mid + 1; }
+        }
+        return {lo, false};
+    }
+
+    /**
+    * @brief the bucket that holds key, keys below the first pivot live in bucket 0
+    */
+    static size_t _bucket_of(std::pair<size_t, bool> pos) { return pos.second || pos.first == 0 ? pos.first : pos.first - 1; }
+
+    /**
+    * @brief publishes l in place of the current layout, _restructure must be held exclusively
+    */
+    void _publish(const _layout* l) {
+        const _layout* old = this->_current.exchange(l, std::memory_order_acq_rel);
+        bubble_detail::epoch_domain::instance().retire(old);
+    }
+
+    bool _insert(const T& key) {
+        const _layout& l = *this->_current.load(std::memory_order_acquire);
+        std::pair<size_t, bool> pos = _locate(l, _proj(key));
+        _bucket& b = l.buckets[_bucket_of(pos)];
+        bool inserted = pos.second ? !b.present.exchange(true, std::memory_order_acq_rel) : b.keys.insert(key);
+        if(inserted) { this->_size.fetch_add(1, std::memory_order_relaxed); }
+        return inserted;
+    }
+
+    size_t _remove(const key_type& key) {
+        const _layout& l = *this->_current.load(std::memory_order_acquire);
+        std::pair<size_t, bool> pos = _locate(l, key);
+        _bucket& b = l.buckets[_bucket_of(pos)];
+        size_t removed = pos.second ? b.present.exchange(false, std::memory_order_acq_rel) : b.keys.remove(key);
+        if(removed) { this->_size.fetch_sub(1, std::memory_order_relaxed); }
+        return removed;
+    }
+
+    /**
+    * @brief calls f with every key of l in sorted order, a guard must be alive
+    */
+    template <typename F>
+    void _each(const _layout& l, F& f) const {
+        for(size_t i = 0; i < l.pivots.size(); i++) {
+            const _bucket& b = l.buckets[i];
+            bool pending = b.present.load(std::memory_order_acquire);
+            b.keys.for_each([&](const T& key) {
+                if(pending && _compare(_proj(key), _proj(l.pivots[i])) > 0) {
+                    std::invoke(f, std::as_const(l.pivots[i]));
+                    pending = false;
+                }
+                std::invoke(f, key);
+            });
+            if(pending) { std::invoke(f, std::as_const(l.pivots[i])); }
+        }
+    }
+
+public:
+    /**
+    * @brief default constructor of concurrent_bubble
+    */
+    explicit concurrent_bubble() : _current(new _layout({})) { }
+
+    /**
+    * @brief constructor of concurrent_bubble from a bubble, it takes over the pivots of b. A
+    * bucket that can adopt a tree shares the trees of b, so it costs O(SIZE), other buckets are
+    * filled in O(n). Pivots taken from real data spread the keys better than the first SIZE keys
+    * that arrive
+    * @param b: the bubble whose keys are copied, it can keep changing once the call returns
+    */
+    explicit concurrent_bubble(const bubble<T, _SIZE, Compare, Projection>& b) {
+        std::vector<T> pivots;
+        for(size_t i = 0; i < b.pivots(); i++) { pivots.push_back(b.get_key(i)); }
+        _layout* l = new _layout(std::move(pivots));
+        bool trees = false;
+        for(size_t i = 0; i < b.pivots(); i++) {
+            tree_type tree = b.get_tree(i);
+            trees = trees || tree.size() > 0;
+            if constexpr(requires { l->buckets[i].keys.adopt(std::move(tree)); }) { l->buckets[i].keys.adopt(std::move(tree)); }
+            else { l->buckets[i].keys.fill(tree.cbegin(), tree.cend()); }
+        }
+        this->_current = l;
+        this->_size = b.size();
+        this->_frozen = trees || b.pivots() == _SIZE;
+    }
+
+    /**
+    * @brief destructor of concurrent_bubble, no other thread may use it anymore
+    */
+    ~concurrent_bubble() { delete this->_current.load(std::memory_order_relaxed); }
+
+    concurrent_bubble(const concurrent_bubble&) = delete;
+    concurrent_bubble& operator=(const concurrent_bubble&) = delete;
+
+    /**
+    * @brief insert function for concurrent_bubble, safe to call from any thread. Until SIZE keys
+    * are stored every key becomes a pivot and a new pivot array is published
+    * @param key: the key you want to insert
+    * @return true: if key was inserted
+    * @return false: if key already exists
+    */
+    bool insert(const T& key) {
+        {
+            std::shared_lock<std::shared_mutex> lock(this->_restructure);
+            if(this->_frozen) { return _insert(key); }
+        }
+        std::unique_lock<std::shared_mutex> lock(this->_restructure);
+        if(this->_frozen) { return _insert(key); }
+        const _layout& l = *this->_current.load(std::memory_order_relaxed);
+        std::pair<size_t, bool> pos = _locate(l, _proj(key));
+        if(pos.second) { return false; }
+        std::vector<T> pivots(l.pivots);
+        pivots.insert(pivots.begin() + pos.first, key);
+        this->_frozen = pivots.size() == _SIZE;
+        _publish(new _layout(std::move(pivots)));
+        this->_size.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+    * @brief remove function for concurrent_bubble, safe to call from any thread
+    * @param key: the key you want to remove
+    * @return size_t: the number of removed keys
+    */
+    size_t remove(const key_type& key) {
+        {
+            std::shared_lock<std::shared_mutex> lock(this->_restructure);
+            if(this->_frozen) { return _remove(key); }
+        }
+        std::unique_lock<std::shared_mutex> lock(this->_restructure);
+        if(this->_frozen) { return _remove(key); }
+        const _layout& l = *this->_current.load(std::memory_order_relaxed);
+        std::pair<size_t, bool> pos = _locate(l, key);
+        if(!pos.second) { return 0; }
+        std::vector<T> pivots(l.pivots);
+        pivots.erase(pivots.begin() + pos.first);
+        _publish(new _layout(std::move(pivots)));
+        this->_size.fetch_sub(1, std::memory_order_relaxed);
+        return 1;
+    }
+
+    /**
+    * @brief rebalance function for concurrent_bubble, picks new pivots that split the current
+    * keys into buckets of equal size and drops the marks of removed pivots. It costs O(n) and
+    * blocks the writers, readers keep using the old pivot array until the new one is published
+    */
+    void rebalance() {
+        std::unique_lock<std::shared_mutex> lock(this->_restructure);
+        std::vector<T> keys;
+        keys.reserve(size());
+        {
+            bubble_detail::epoch_domain::guard reading;
+            auto collect = [&](const T& key) { keys.push_back(key); };
+            _each(*this->_current.load(std::memory_order_relaxed), collect);
+        }
+        size_t buckets = std::min(keys.size(), _SIZE);
+        std::vector<T> pivots;
+        pivots.reserve(buckets);
+        for(size_t i = 0; i < buckets; i++) { pivots.push_back(keys[i * keys.size() / buckets]); }
+        _layout* l = new _layout(std::move(pivots));
+        for(size_t i = 0; i < buckets; i++) {
+            size_t first = i * keys.size() / buckets + 1, last = (i + 1) * keys.size() / buckets;
+            if(first < last) { l->buckets[i].keys.fill(keys.begin() + first, keys.begin() + last); }
+        }
+        this->_frozen = keys.size() >= _SIZE;
+        _publish(l);
+    }
+
+    /**
+    * @brief search function for concurrent_bubble, safe to call from any thread. It takes no lock
+    * and only writes to memory of the calling thread, so writers never delay it
+    * @return true: if key exists
+    * @return false: otherwise
+    */
+    bool search(const key_type& key) const {
+        bubble_detail::epoch_domain::guard reading;
+        const _layout& l = *this->_current.load(std::memory_order_acquire);
+        if(l.pivots.empty()) { return false; }
+        std::pair<size_t, bool> pos = _locate(l, key);
+        const _bucket& b = l.buckets[_bucket_of(pos)];
+        if(pos.second) { return b.present.load(std::memory_order_acquire); }
+        return b.keys.search(key);
+    }
+
+    /**
+    * @brief for_each function for concurrent_bubble, visits the keys in sorted order without
+    * blocking writers. Writes that run during the walk may or may not show up
+    * @param f: called with const T& for every key, it must not call into this concurrent_bubble
+    */
+    template <typename F>
+    void for_each(F&& f) const {
+        bubble_detail::epoch_domain::guard reading;
+        _each(*this->_current.load(std::memory_order_acquire), f);
+    }
+
+    /**
+    * @brief size function for concurrent_bubble
+    * @return size_t: the number of keys, exact once no write is running
+    */
+    size_t size() const { return this->_size.load(std::memory_order_relaxed); }
+
+    /**
+    * @brief empty function for concurrent_bubble
+    * @return true: if concurrent_bubble is empty
+    * @return false: otherwise
+    */
+    bool empty() const { return size() == 0; }
+};
+
+#endif
@@ -0,0 +1,172 @@
+/**
+* @brief Epoch based memory reclamation for the concurrent containers. A reader announces the
+* global epoch in a slot that belongs to its thread before it touches shared nodes and clears it
+* afterwards, so reading never writes to memory that other threads use. A writer that unlinks an
+* object retires it instead of freeing it, and the object is freed once every reader that could
+* still reach it has left
+*/
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#ifdef __cplusplus
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+#endif
+
+namespace bubble_detail {
+
+/**
+* @brief the process wide reclamation domain, every concurrent container retires into it
+*/
+class epoch_domain {
+private:
+    /**
+    * @brief the announcement of one thread, a slot is handed to the next thread once its owner
+    * exits and it sits on its own cache line
+    */
+    struct alignas(64) _slot {
+        // the epoch the owner entered, 0 while it is not reading
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> taken{true};
+        // guards of the owner that are currently alive, only the owner touches it
+        size_t depth{0};
+        _slot* next{nullptr};
+    };
+
+    struct _retired {
+        uint64_t epoch;
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    std::atomic<uint64_t> _epoch{1};
+    std::atomic<_slot*> _slots{nullptr};
+    std::mutex _lock;
+    std::vector<_retired> _retired_list;
+
+    epoch_domain() = default;
+
+    ~epoch_domain() {
+        for(auto && r : this->_retired_list) { r.destroy(r.object); }
+        for(_slot* s = this->_slots.load(); s != nullptr;) { delete std::exchange(s, s->next); }
+    }
+
+    _slot* _acquire_slot() {
+        for(_slot* s = this->_slots.load(std::memory_order_acquire); s != nullptr; s = s->next) {
+            bool expected = false;
+            if(!s->taken.load(std::memory_order_relaxed) && s->taken.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return s;
+            }
+        }
+        _slot* s = new _slot;
+        s->next = this->_slots.load(std::memory_order_relaxed);
+        while(!this->_slots.compare_exchange_weak(s->next, s, std::memory_order_release, std::memory_order_relaxed)) {}
+        return s;
+    }
+
+    /**
+    * @brief the slot of the calling thread, it is given back when the thread exits
+    */
+    _slot& _local() {
+        struct owner {
+            _slot* s;
+            ~owner() { s->taken.store(false, std::memory_order_release); }
+        };
+        thread_local owner mine{_acquire_slot()};
+        return *mine.s;
+    }
+
+    /**
+    * @brief frees every retired object that no reader can reach anymore, _lock must be held
+    */
+    void _collect() {
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for(_slot* s = this->_slots.load(std::memory_order_acquire); s != nullptr; s = s->next) {
+            uint64_t e = s->epoch.load(std::memory_order_seq_cst);
+            if(e != 0) { oldest = std::min(oldest, e); }
+        }
+        // a reader that entered at an epoch bigger than the one of the retirement started after
+        // the object was unlinked
+        auto reachable = std::partition(this->_retired_list.begin(), this->_retired_list.end(), [&](const _retired& r) { return r.epoch >= oldest; });
+        std::vector<_retired> done(reachable, this->_retired_list.end());
+        this->_retired_list.erase(reachable, this->_retired_list.end());
+        for(auto && r : done) { r.destroy(r.object); }
+    }
+
+public:
+    /**
+    * @brief the domain, created on first use
+    */
+    static epoch_domain& instance() {
+        static epoch_domain domain;
+        return domain;
+    }
+
+    /**
+    * @brief a read section. Shared objects that were reachable when the guard was created stay
+    * alive until it is destroyed, guards of the same thread nest
+    */
+    class guard {
+    private:
+        _slot& s;
+
+    public:
+        explicit guard(epoch_domain& domain = instance()) : s(domain._local()) {
+            if(s.depth++ == 0) {
+                s.epoch.store(domain._epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                // the announcement has to be visible before the reader loads a shared pointer
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+        ~guard() {
+            if(--s.depth == 0) { s.epoch.store(0, std::memory_order_release); }
+        }
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+    };
+
+    /**
+    * @brief retire function, frees p once no guard that could have reached it is alive. It must
+    * already be unlinked, readers that start from now on must not be able to find it
+    * @param p: the object, it was allocated with new
+    */
+    template <typename P>
+    void retire(P* p) {
+        retire(const_cast<void*>(static_cast<const void*>(p)), [](void* object) { delete static_cast<P*>(object); });
+    }
+
+    void retire(void* object, void (*destroy)(void*)) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t epoch = this->_epoch.fetch_add(1, std::memory_order_seq_cst);
+        std::lock_guard<std::mutex> lock(this->_lock);
+        this->_retired_list.push_back({epoch, object, destroy});
+        if(this->_retired_list.size() >= 64) { _collect(); }
+    }
+
+    /**
+    * @brief collect function, frees what can be freed right now
+    */
+    void collect() {
+        std::lock_guard<std::mutex> lock(this->_lock);
+        _collect();
+    }
+
+    /**
+    * @brief pending function
+    * @return size_t: the number of retired objects that are not freed yet
+    */
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(this->_lock);
+        return this->_retired_list.size();
+    }
+};
+
+}
+
+#endif
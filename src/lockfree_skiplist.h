@@ -0,0 +1,294 @@
+/**
+* @brief Implementation of the lockfree_skiplist data structure, a sorted set that any number of
+* threads change at once without locks. Every level is a linked list whose links carry a mark bit,
+* a key is removed by marking its links and any thread that walks past a marked node unlinks it.
+* Nodes are freed by epoch based reclamation once both the insertion and the removal of the node
+* are done with it. It is the bucket of concurrent_bubble for write heavy workloads, but it can be
+* used on its own as well
+*/
+
+#ifndef LOCKFREE_SKIPLIST_H
+#define LOCKFREE_SKIPLIST_H
+
+#ifdef __cplusplus
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "avl_tree.h"
+#include "epoch.h"
+#endif
+
+/**
+* @brief implementation of lockfree_skiplist<T, Compare, Projection>
+*/
+template <typename T, typename Compare = std::less<>, auto Projection = std::identity{}>
+class lockfree_skiplist {
+public:
+    using key_type = std::remove_cvref_t<std::invoke_result_t<decltype(Projection), const T&>>;
+    static constexpr unsigned max_height = 16;
+
+private:
+    using link = std::atomic<uintptr_t>;
+
+    /**
+    * @brief a node, its height links follow it in the same allocation. owners counts the
+    * insertion and the removal that still use the node, the last one retires it
+    */
+    struct alignas(T) alignas(link) _node {
+        T key;
+        unsigned height;
+        std::atomic<int> owners;
+
+        _node(const T& key, unsigned height, int owners) : key(key), height(height), owners(owners) {}
+
+        link* next() { return reinterpret_cast<link*>(this + 1); }
+        const link* next() const { return reinterpret_cast<const link*>(this + 1); }
+    };
+
+    static_assert(alignof(_node) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+    link _head[max_height];
+    std::atomic<size_t> _size{0};
+    [[no_unique_address]] Compare comp{};
+
+    static decltype(auto) _proj(const T& x) { return std::invoke(Projection, x); }
+
+    auto _compare(const key_type& a, const key_type& b) const { return bubble_detail::three_way(comp, a, b); }
+
+    static _node* _ptr(uintptr_t v) { return reinterpret_cast<_node*>(v & ~uintptr_t(1)); }
+    static bool _marked(uintptr_t v) { return v & 1; }
+    static uintptr_t _bits(const _node* n) { return reinterpret_cast<uintptr_t>(n); }
+
+    static _node* _create(const T& key, unsigned height, int owners) {
+        void* raw = ::operator new(sizeof(_node) + height * sizeof(link));
+        _node* n = new(raw) _node(key, height, owners);
+        for(unsigned i = 0; i < height; i++) { new(&n->next()[i]) link(0); }
+        return n;
+    }
+
+    static void _destroy(void* raw) {
+        static_cast<_node*>(raw)->~_node();
+        ::operator delete(raw);
+    }
+
+    /**
+    * @brief drops one owner of n, the last one hands it to the reclamation
+    */
+    static void _release(_node* n) {
+        if(n->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) { bubble_detail::epoch_domain::instance().retire(n, &_destroy); }
+    }
+
+    /**
+    * @brief the height of a new node, every level is taken with probability 1/4
+    */
+    static unsigned _random_height() {
+        thread_local uint64_t state = reinterpret_cast<uintptr_t>(&state) | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        unsigned height = 1;
+        for(uint64_t bits = state; height < max_height && (bits & 3) == 0; bits >>= 2) { height++; }
+        return height;
+    }
+
+    /**
+    * @brief finds the links in front of key and the nodes behind them on every level and unlinks
+    * the marked nodes it walks past. A guard must be alive
+    * @return true: if an unmarked node holds key, it is succs[0]
+    * @return false: otherwise
+    */
+    bool _find(const key_type& key, link** preds, _node** succs) {
+    retry:
+        link* pred = this->_head;
+        for(unsigned level = max_height; level-- > 0;) {
+            uintptr_t v = pred[level].load(std::memory_order_acquire);
+            if(_marked(v)) { goto retry; }
+            _node* curr = _ptr(v);
+            while(curr != nullptr) {
+                uintptr_t succ = curr->next()[level].load(std::memory_order_acquire);
+                if(_marked(succ)) {
+                    uintptr_t expected = _bits(curr);
+                    if(!pred[level].compare_exchange_strong(expected, succ & ~uintptr_t(1), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        goto retry;
+                    }
+                    curr = _ptr(succ);
+                    continue;
+                }
+                if(_compare(_proj(curr->key), key) >= 0) { break; }
+                pred = curr->next();
+                curr = _ptr(succ);
+            }
+            preds[level] = pred;
+            succs[level] = curr;
+        }
+        return succs[0] != nullptr && _compare(_proj(succs[0]->key), key) == 0;
+    }
+
+public:
+    /**
+    * @brief default constructor of lockfree_skiplist
+    */
+    explicit lockfree_skiplist() noexcept {
+        for(auto && l : this->_head) { l.store(0, std::memory_order_relaxed); }
+    }
+
+    /**
+    * @brief destructor of lockfree_skiplist, no other thread may use it anymore
+    */
+    ~lockfree_skiplist() {
+        for(_node* n = _ptr(this->_head[0].load(std::memory_order_relaxed)); n != nullptr;) {
+            _node* next = _ptr(n->next()[0].load(std::memory_order_relaxed));
+            _destroy(n);
+            n = next;
+        }
+    }
+
+    lockfree_skiplist(const lockfree_skiplist&) = delete;
+    lockfree_skiplist& operator=(const lockfree_skiplist&) = delete;
+
+    /**
+    * @brief fill function for lockfree_skiplist, links strictly increasing keys in O(n) without
+    * comparing them. The skiplist must be empty and no other thread may use it yet
+    */
+    template <std::input_iterator It>
+    void fill(It first, It last) {
+        link* tail[max_height];
+        for(unsigned level = 0; level < max_height; level++) { tail[level] = this->_head; }
+        size_t count = 0;
+        for(; first != last; ++first, ++count) {
+            _node* n = _create(*first, _random_height(), 1);
+            for(unsigned level = 0; level < n->height; level++) {
+                tail[level][level].store(_bits(n), std::memory_order_relaxed);
+                tail[level] = n->next();
+            }
+        }
+        this->_size.store(count, std::memory_order_release);
+    }
+
+    /**
+    * @brief insert function for lockfree_skiplist, safe to call from any thread
+    * @param key: the key you want to insert
+    * @return true: if key was inserted
+    * @return false: if key already exists
+    */
+    bool insert(const T& key) {
+        bubble_detail::epoch_domain::guard reading;
+        link* preds[max_height];
+        _node* succs[max_height];
+        _node* n = nullptr;
+        for(;;) {
+            if(_find(_proj(key), preds, succs)) {
+                if(n != nullptr) { _destroy(n); }
+                return false;
+            }
+            if(n == nullptr) { n = _create(key, _random_height(), 2); }
+            for(unsigned level = 0; level < n->height; level++) { n->next()[level].store(_bits(succs[level]), std::memory_order_relaxed); }
+            uintptr_t expected = _bits(succs[0]);
+            if(preds[0][0].compare_exchange_strong(expected, _bits(n), std::memory_order_acq_rel, std::memory_order_acquire)) { break; }
+        }
+        this->_size.fetch_add(1, std::memory_order_relaxed);
+        // the key is in the set now, the upper levels only make it faster to find
+        for(unsigned level = 1; level < n->height; level++) {
+            for(;;) {
+                // a retry refreshes succs on every level, the link of n has to follow before n is
+                // published there, a stale successor may already be retired
+                uintptr_t old = n->next()[level].load(std::memory_order_acquire);
+                // a removal marks the links of n, they must not be overwritten then
+                if(_marked(old)) { goto linked; }
+                if(old != _bits(succs[level]) && !n->next()[level].compare_exchange_strong(old, _bits(succs[level]), std::memory_order_acq_rel)) { goto linked; }
+                uintptr_t expected = _bits(succs[level]);
+                if(preds[level][level].compare_exchange_strong(expected, _bits(n), std::memory_order_acq_rel, std::memory_order_acquire)) { break; }
+                if(!_find(_proj(key), preds, succs) || succs[0] != n) { goto linked; }
+            }
+        }
+    linked:
+        // a removal that ran while the upper levels were linked may have missed some of them
+        if(_marked(n->next()[0].load(std::memory_order_acquire))) { _find(_proj(key), preds, succs); }
+        _release(n);
+        return true;
+    }
+
+    /**
+    * @brief remove function for lockfree_skiplist, safe to call from any thread
+    * @param key: the key you want to remove
+    * @return size_t: the number of removed keys
+    */
+    size_t remove(const key_type& key) {
+        bubble_detail::epoch_domain::guard reading;
+        link* preds[max_height];
+        _node* succs[max_height];
+        if(!_find(key, preds, succs)) { return 0; }
+        _node* n = succs[0];
+        for(unsigned level = n->height; level-- > 1;) {
+            uintptr_t v = n->next()[level].load(std::memory_order_acquire);
+            while(!_marked(v) && !n->next()[level].compare_exchange_weak(v, v | 1, std::memory_order_acq_rel)) {}
+        }
+        // whoever marks the bottom link removes the key
+        uintptr_t v = n->next()[0].load(std::memory_order_acquire);
+        while(!_marked(v)) {
+            if(n->next()[0].compare_exchange_weak(v, v | 1, std::memory_order_acq_rel)) {
+                this->_size.fetch_sub(1, std::memory_order_relaxed);
+                _find(key, preds, succs);
+                _release(n);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    /**
+    * @brief search function for lockfree_skiplist, safe to call from any thread. It never writes
+    * to shared memory, marked nodes are skipped instead of unlinked
+    * @return true: if key exists
+    * @return false: otherwise
+    */
+    bool search(const key_type& key) const {
+        bubble_detail::epoch_domain::guard reading;
+        const link* pred = this->_head;
+        const _node* curr = nullptr;
+        for(unsigned level = max_height; level-- > 0;) {
+            curr = _ptr(pred[level].load(std::memory_order_acquire));
+            while(curr != nullptr) {
+                uintptr_t succ = curr->next()[level].load(std::memory_order_acquire);
+                if(!_marked(succ) && _compare(_proj(curr->key), key) >= 0) { break; }
+                if(!_marked(succ)) { pred = curr->next(); }
+                curr = _ptr(succ);
+            }
+        }
+        return curr != nullptr && _compare(_proj(curr->key), key) == 0;
+    }
+
+    /**
+    * @brief for_each function for lockfree_skiplist, visits the keys in sorted order. Keys that
+    * are inserted or removed during the walk may or may not be visited
+    * @param f: called with const T& for every key
+    */
+    template <typename F>
+    void for_each(F&& f) const {
+        bubble_detail::epoch_domain::guard reading;
+        for(const _node* n = _ptr(this->_head[0].load(std::memory_order_acquire)); n != nullptr;) {
+            uintptr_t next = n->next()[0].load(std::memory_order_acquire);
+            if(!_marked(next)) { std::invoke(f, std::as_const(n->key)); }
+            n = _ptr(next);
+        }
+    }
+
+    /**
+    * @brief size function for lockfree_skiplist
+    * @return size_t: the number of keys, exact once no write is running
+    */
+    size_t size() const { return this->_size.load(std::memory_order_relaxed); }
+
+    /**
+    * @brief empty function for lockfree_skiplist
+    * @return true: if lockfree_skiplist is empty
+    * @return false: otherwise
+    */
+    bool empty() const { return size() == 0; }
+};
+
+#endif
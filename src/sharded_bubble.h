@@ -0,0 +1,318 @@
+/**
+* @brief Implementation of the sharded_bubble data structure, a bubble whose keys are split by range
+* over shards that each belong to one worker thread. No two threads ever touch the same bubble: the
+* caller routes every batch over a pivot table and hands each shard its part through a single
+* producer single consumer queue, the worker applies it to its own bubble and fulfils a future once
+* the last shard of the batch is done. Iteration visits the shards in the order of the pivot table,
+* so it sees the keys sorted
+*/
+
+#ifndef SHARDED_BUBBLE_H
+#define SHARDED_BUBBLE_H
+
+#ifdef __cplusplus
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "bubble.h"
+#include "spsc_queue.h"
+#endif
+
+/**
+* @brief implementation of sharded_bubble<T, SIZE, Compare, Projection>. Only one thread at a time
+* may call its members, it is the producer of every shard queue
+*/
+template <typename T, size_t _SIZE, typename Compare = std::less<>, auto Projection = std::identity{}>
+class sharded_bubble {
+public:
+    using bubble_type = bubble<T, _SIZE, Compare, Projection>;
+    using key_type = typename bubble_type::key_type;
+
+private:
+    // an empty task stops the worker
+    using _task = std::function<void(bubble_type&)>;
+
+    struct _shard {
+        bubble_detail::spsc_queue<_task> queue;
+        // the size of the bubble, the worker stores it before it reports a batch as done
+        std::atomic<size_t> size{0};
+        std::thread worker;
+
+        explicit _shard(size_t capacity) : queue(capacity) {}
+    };
+
+    /**
+    * @brief a batch whose result is the number of keys it changed
+    */
+    struct _counted {
+        std::promise<size_t> promise;
+        std::atomic<size_t> pending, count{0};
+
+        explicit _counted(size_t parts) : pending(parts) {}
+
+        void done(size_t n) {
+            this->count.fetch_add(n, std::memory_order_relaxed);
+            if(this->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) { this->promise.set_value(this->count.load(std::memory_order_relaxed)); }
+        }
+    };
+
+    /**
+    * @brief a batch whose result is one answer per key, every shard writes the answers of its keys
+    */
+    struct _answered {
+        std::promise<std::vector<bool>> promise;
+        std::atomic<size_t> pending;
+        std::unique_ptr<bool[]> found;
+        size_t n;
+
+        _answered(size_t parts, size_t n) : pending(parts), found(new bool[n]()), n(n) {}
+
+        void done() {
+            if(this->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) { this->promise.set_value(std::vector<bool>(this->found.get(), this->found.get() + this->n)); }
+        }
+    };
+
+    // key k belongs to shard i when _bounds[i - 1] <= k < _bounds[i]
+    std::vector<T> _bounds;
+    std::vector<std::unique_ptr<_shard>> _shards;
+    [[no_unique_address]] Compare comp{};
+
+    static decltype(auto) _proj(const T& x) { return std::invoke(Projection, x); }
+
+    auto _compare(const key_type& a, const key_type& b) const { return bubble_detail::three_way(comp, a, b); }
+
+    /**
+    * @brief the shard that owns key, a binary search over the pivot table
+    */
+    size_t _shard_of(const key_type& key) const {
+        size_t lo = 0, hi = this->_bounds.size();
+        while(lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if(_compare(key, _proj(this->_bounds[mid])) < 0) { hi = mid; }
+            else { lo = mid + 1; }
+        }
+        return lo;
+    }
+
+    static void _run(_shard& s, bubble_type keys) {
+        for(;;) {
+            _task task = s.queue.pop();
+            if(!task) { return; }
+            task(keys);
+        }
+    }
+
+    void _start(std::vector<bubble_type>&& parts, size_t capacity) {
+        for(auto && part : parts) {
+            this->_shards.push_back(std::make_unique<_shard>(capacity));
+            this->_shards.back()->size.store(part.size(), std::memory_order_relaxed);
+            this->_shards.back()->worker = std::thread(&_run, std::ref(*this->_shards.back()), std::move(part));
+        }
+    }
+
+    /**
+    * @brief splits items over the shards, key(item) is the key that routes item
+    */
+    template <typename Item, typename Key>
+    std::vector<std::vector<Item>> _route(std::vector<Item>&& items, Key&& key) const {
+        std::vector<std::vector<Item>> parts(this->_shards.size());
+        for(auto && item : items) { parts[_shard_of(key(item))].push_back(std::move(item)); }
+        return parts;
+    }
+
+    /**
+    * @brief queues one task for every shard that got a non empty part
+    * @param make: called with the size of the shard and its part, returns the task for it
+    */
+    template <typename Part, typename F>
+    void _post(std::vector<Part>& parts, F&& make) {
+        for(size_t i = 0; i < parts.size(); i++) {
+            if(!parts[i].empty()) { this->_shards[i]->queue.push(make(this->_shards[i]->size, std::move(parts[i]))); }
+        }
+    }
+
+    template <typename Part>
+    static size_t _non_empty(const std::vector<Part>& parts) {
+        return std::ranges::count_if(parts, [](const Part& p) { return !p.empty(); });
+    }
+
+    template <typename R>
+    static std::future<R> _ready(R value) {
+        std::promise<R> promise;
+        promise.set_value(std::move(value));
+        return promise.get_future();
+    }
+
+public:
+    /**
+    * @brief constructor of sharded_bubble from a pivot table
+    * @param bounds: strictly increasing keys, shard i starts at bounds[i - 1], so there is one
+    * shard more than bounds
+    * @param capacity: the number of batches that can wait in the queue of a shard
+    */
+    explicit sharded_bubble(std::vector<T> bounds, size_t capacity = 1024) : _bounds(std::move(bounds)) {
+        _start(std::vector<bubble_type>(this->_bounds.size() + 1), capacity);
+    }
+
+    /**
+    * @brief constructor of sharded_bubble from a bubble, the pivot table splits its keys into
+    * shards of equal size and every shard takes over its part with bubble::split, so no key is
+    * inserted again
+    * @param keys: the keys to start with
+    * @param shards: the number of worker threads, at most one per key
+    * @param capacity: the number of batches that can wait in the queue of a shard
+    */
+    sharded_bubble(bubble_type keys, size_t shards, size_t capacity = 1024) {
+        shards = std::clamp<size_t>(shards, 1, std::max<size_t>(keys.size(), 1));
+        for(size_t i = 1; i < shards; i++) { this->_bounds.push_back(*keys.select(i * keys.size() / shards)); }
+        std::vector<bubble_type> parts(shards);
+        for(size_t i = shards - 1; i > 0; i--) { parts[i] = keys.split(_proj(this->_bounds[i - 1])); }
+        parts[0] = std::move(keys);
+        _start(std::move(parts), capacity);
+    }
+
+    /**
+    * @brief destructor of sharded_bubble, the workers finish the batches they got and stop
+    */
+    ~sharded_bubble() {
+        for(auto && s : this->_shards) { s->queue.push(_task()); }
+        for(auto && s : this->_shards) { s->worker.join(); }
+    }
+
+    sharded_bubble(const sharded_bubble&) = delete;
+    sharded_bubble& operator=(const sharded_bubble&) = delete;
+
+    /**
+    * @brief insert function for sharded_bubble, the shards insert their part of keys in parallel.
+    * Batches reach a shard in the order they were made, so a later batch sees these keys
+    * @param keys: the keys you want to insert
+    * @return std::future<size_t>: the number of keys that were inserted
+    */
+    std::future<size_t> insert(std::vector<T> keys) {
+        auto parts = _route(std::move(keys), [](const T& key) -> decltype(auto) { return _proj(key); });
+        size_t n = _non_empty(parts);
+        if(n == 0) { return _ready<size_t>(0); }
+        auto batch = std::make_shared<_counted>(n);
+        std::future<size_t> result = batch->promise.get_future();
+        _post(parts, [&](std::atomic<size_t>& size, std::vector<T>&& part) {
+            return [batch, &size, part = std::move(part)](bubble_type& b) {
+                size_t inserted = 0;
+                for(auto && key : part) { inserted += b.insert(key).second; }
+                size.store(b.size(), std::memory_order_relaxed);
+                batch->done(inserted);
+            };
+        });
+        return result;
+    }
+
+    /**
+    * @brief remove function for sharded_bubble
+    * @param keys: the keys you want to remove
+    * @return std::future<size_t>: the number of keys that were removed
+    */
+    std::future<size_t> remove(std::vector<key_type> keys) {
+        auto parts = _route(std::move(keys), [](const key_type& key) -> const key_type& { return key; });
+        size_t n = _non_empty(parts);
+        if(n == 0) { return _ready<size_t>(0); }
+        auto batch = std::make_shared<_counted>(n);
+        std::future<size_t> result = batch->promise.get_future();
+        _post(parts, [&](std::atomic<size_t>& size, std::vector<key_type>&& part) {
+            return [batch, &size, part = std::move(part)](bubble_type& b) {
+                size_t removed = 0;
+                for(auto && key : part) { removed += b.remove(key); }
+                size.store(b.size(), std::memory_order_relaxed);
+                batch->done(removed);
+            };
+        });
+        return result;
+    }
+
+    /**
+    * @brief search function for sharded_bubble
+    * @param keys: the keys you want to look up
+    * @return std::future<std::vector<bool>>: for every key in the order of keys, true if it exists
+    */
+    std::future<std::vector<bool>> search(std::vector<key_type> keys) {
+        std::vector<std::pair<size_t, key_type>> indexed;
+        indexed.reserve(keys.size());
+        for(size_t i = 0; i < keys.size(); i++) { indexed.emplace_back(i, std::move(keys[i])); }
+        auto parts = _route(std::move(indexed), [](const std::pair<size_t, key_type>& p) -> const key_type& { return p.second; });
+        size_t n = _non_empty(parts);
+        if(n == 0) { return _ready(std::vector<bool>()); }
+        auto batch = std::make_shared<_answered>(n, keys.size());
+        std::future<std::vector<bool>> result = batch->promise.get_future();
+        _post(parts, [&](std::atomic<size_t>&, std::vector<std::pair<size_t, key_type>>&& part) {
+            return [batch, part = std::move(part)](bubble_type& b) {
+                for(auto && [i, key] : part) { batch->found[i] = b.search(key); }
+                batch->done();
+            };
+        });
+        return result;
+    }
+
+    /**
+    * @brief snapshot function for sharded_bubble, every shard hands out a snapshot of its bubble
+    * in O(SIZE) once it got through the batches before it
+    * @return std::future<std::vector<bubble_type>>: the shards in key order
+    */
+    std::future<std::vector<bubble_type>> snapshot() {
+        struct gathered {
+            std::promise<std::vector<bubble_type>> promise;
+            std::atomic<size_t> pending;
+            std::vector<bubble_type> shards;
+        };
+        auto batch = std::make_shared<gathered>();
+        batch->pending = this->_shards.size();
+        batch->shards.resize(this->_shards.size());
+        std::future<std::vector<bubble_type>> result = batch->promise.get_future();
+        for(size_t i = 0; i < this->_shards.size(); i++) {
+            this->_shards[i]->queue.push([batch, i](bubble_type& b) {
+                batch->shards[i] = b.snapshot();
+                if(batch->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) { batch->promise.set_value(std::move(batch->shards)); }
+            });
+        }
+        return result;
+    }
+
+    /**
+    * @brief for_each function for sharded_bubble, visits every key in sorted order on the calling
+    * thread. It waits for the batches made before it, the workers go on with later ones meanwhile
+    * @param f: called with const T& for every key
+    */
+    template <typename F>
+    void for_each(F&& f) {
+        for(const bubble_type& shard : snapshot().get()) {
+            for(auto it = shard.cbegin(); it != shard.cend(); ++it) { std::invoke(f, *it); }
+        }
+    }
+
+    /**
+    * @brief shards function for sharded_bubble
+    * @return size_t: the number of shards and worker threads
+    */
+    size_t shards() const { return this->_shards.size(); }
+
+    /**
+    * @brief size function for sharded_bubble
+    * @return size_t: the number of keys, exact once the futures of every batch are ready
+    */
+    size_t size() const {
+        size_t total = 0;
+        for(auto && s : this->_shards) { total += s->size.load(std::memory_order_relaxed); }
+        return total;
+    }
+
+    /**
+    * @brief empty function for sharded_bubble
+    * @return true: if sharded_bubble is empty
+    * @return false: otherwise
+    */
+    bool empty() const { return size() == 0; }
+};
+
+#endif
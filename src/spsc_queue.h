@@ -0,0 +1,106 @@
+/**
+* @brief A bounded queue between exactly one producer thread and one consumer thread. Each side
+* owns one index and only reads the other, so a push or a pop is a load and a store without any
+* read-modify-write. The indexes sit on their own cache lines and each side caches the index of
+* the other side, so it only touches the shared line when the cached value says the queue looks
+* full or empty. A side that has to wait sleeps on the index it waits for
+*/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#ifdef __cplusplus
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+#endif
+
+namespace bubble_detail {
+
+/**
+* @brief implementation of spsc_queue<T>
+*/
+template <typename T>
+class spsc_queue {
+private:
+    const size_t _mask;
+    std::unique_ptr<std::optional<T>[]> _items;
+    // written by the consumer, the next item to pop
+    alignas(64) std::atomic<size_t> _head{0};
+    size_t _tail_seen{0};
+    // written by the producer, the next free item
+    alignas(64) std::atomic<size_t> _tail{0};
+    size_t _head_seen{0};
+
+public:
+    /**
+    * @brief constructor of spsc_queue
+    * @param capacity: the most items the queue holds, rounded up to a power of two
+    */
+    explicit spsc_queue(size_t capacity) : _mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), _items(new std::optional<T>[_mask + 1]) {}
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    /**
+    * @brief try_push function for spsc_queue, only the producer calls it
+    * @return true: if item was queued
+    * @return false: if the queue is full, then item is left as it was
+    */
+    bool try_push(T& item) {
+        size_t tail = this->_tail.load(std::memory_order_relaxed);
+        if(tail - this->_head_seen > this->_mask) {
+            this->_head_seen = this->_head.load(std::memory_order_acquire);
+            if(tail - this->_head_seen > this->_mask) { return false; }
+        }
+        this->_items[tail & this->_mask].emplace(std::move(item));
+        this->_tail.store(tail + 1, std::memory_order_release);
+        this->_tail.notify_one();
+        return true;
+    }
+
+    /**
+    * @brief push function for spsc_queue, only the producer calls it. It sleeps while the queue
+    * is full
+    */
+    void push(T item) {
+        while(!try_push(item)) { this->_head.wait(this->_head_seen, std::memory_order_acquire); }
+    }
+
+    /**
+    * @brief try_pop function for spsc_queue, only the consumer calls it
+    * @return std::optional<T>: the oldest item, or nothing if the queue is empty
+    */
+    std::optional<T> try_pop() {
+        size_t head = this->_head.load(std::memory_order_relaxed);
+        if(head == this->_tail_seen) {
+            this->_tail_seen = this->_tail.load(std::memory_order_acquire);
+            if(head == this->_tail_seen) { return std::nullopt; }
+        }
+        std::optional<T> item = std::move(this->_items[head & this->_mask]);
+        this->_items[head & this->_mask].reset();
+        this->_head.store(head + 1, std::memory_order_release);
+        this->_head.notify_one();
+        return item;
+    }
+
+    /**
+    * @brief pop function for spsc_queue, only the consumer calls it. It sleeps while the queue is
+    * empty
+    * @return T: the oldest item
+    */
+    T pop() {
+        for(;;) {
+            if(std::optional<T> item = try_pop()) { return std::move(*item); }
+            this->_tail.wait(this->_tail_seen, std::memory_order_acquire);
+        }
+    }
+};
+
+}
+
+#endif
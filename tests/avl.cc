@@ -37,6 +37,16 @@ TEST_CASE("checking removals in avl") {
   REQUIRE(v == inorder);
 }
 
+TEST_CASE("checking duplicates and missing keys in avl") {
+  avl_tree<int> a1({5, 3, 8});
+  REQUIRE(a1.insert(3).second == false);
+  REQUIRE(a1.insert(4).second == true);
+  REQUIRE(a1.size() == 4);
+  REQUIRE(a1.remove(7) == false);
+  REQUIRE(a1.remove(8) == true);
+  REQUIRE(a1.size() == 3);
+}
+
 TEST_CASE("checking inorder in avl") {
   avl_tree<char> a2;
   a2.insert('g');
@@ -162,3 +172,390 @@ TEST_CASE("Testing get_root function in avl tree"){
   t.remove(35);
   REQUIRE(t.get_root() == 36);
 }
+
+TEST_CASE("Testing custom comparator and projection in avl tree"){
+  avl_tree<int, std::greater<>> t({1, 5, 3, 4, 2});
+  REQUIRE(t.inorder() == std::vector<int>{5, 4, 3, 2, 1});
+  REQUIRE(t.search(3) == true);
+  REQUIRE(t.insert(3).second == false);
+  REQUIRE(*t.insert(6).first == 6);
+  REQUIRE(t.remove(6) == true);
+  REQUIRE(t.size() == 5);
+
+  avl_tree<std::pair<int, std::string>, std::less<>,
+           &std::pair<int, std::string>::first>
+      p;
+  p.insert({3, "c"});
+  p.insert({1, "a"});
+  p.insert({2, "b"});
+  REQUIRE(p.search(2) == true);
+  REQUIRE(p.remove(2) == true);
+  REQUIRE(p.remove(2) == false);
+  REQUIRE(p.size() == 2);
+  REQUIRE(p.inorder()[1].second == "c");
+}
+
+namespace {
+struct counted_key {
+  int value;
+  static inline size_t comparisons = 0;
+  friend bool operator<(const counted_key &a, const counted_key &b) {
+    comparisons++;
+    return a.value < b.value;
+  }
+  friend std::strong_ordering operator<=>(const counted_key &a,
+                                          const counted_key &b) {
+    comparisons++;
+    return a.value <=> b.value;
+  }
+};
+} // namespace
+
+TEST_CASE("Testing three-way comparisons in avl tree"){
+  avl_tree<int, std::compare_three_way> t({5, 3, 8, 1, 4});
+  REQUIRE(t.inorder() == std::vector<int>{1, 3, 4, 5, 8});
+  REQUIRE(t.search(4) == true);
+  REQUIRE(t.remove(5) == true);
+  REQUIRE(t.search(5) == false);
+
+  avl_tree<counted_key> c;
+  for (int i = 0; i < 1024; i++) {
+    c.insert({i});
+  }
+  // a balanced tree of 1024 nodes has 11 levels at most with one comparison each
+  counted_key::comparisons = 0;
+  REQUIRE(c.search({1023}) == true);
+  REQUIRE(counted_key::comparisons <= 11);
+  counted_key::comparisons = 0;
+  REQUIRE(c.search({2048}) == false);
+  REQUIRE(counted_key::comparisons <= 11);
+}
+
+TEST_CASE("Testing rebalancing on removals in avl tree"){
+  avl_tree<int> t;
+  for (int i = 0; i < 64; i++) {
+    t.insert(i);
+  }
+  for (int i = 0; i < 48; i++) {
+    REQUIRE(t.remove(i) == true);
+  }
+  REQUIRE(t.size() == 16);
+  REQUIRE(t.level_order().size() == 5);
+}
+
+TEST_CASE("Testing find and bounds in avl tree"){
+  avl_tree<int> t({10, 20, 30, 40, 50});
+  REQUIRE(*t.find(30) == 30);
+  REQUIRE(t.find(35) == t.cend());
+  REQUIRE(*t.lower_bound(30) == 30);
+  REQUIRE(*t.lower_bound(31) == 40);
+  REQUIRE(*t.upper_bound(30) == 40);
+  REQUIRE(t.upper_bound(50) == t.cend());
+  REQUIRE(*t.predecessor(30) == 20);
+  REQUIRE(t.predecessor(10) == nullptr);
+  REQUIRE(*t.first() == 10);
+  REQUIRE(*t.last() == 50);
+  avl_tree<int> empty;
+  REQUIRE(empty.first() == nullptr);
+}
+
+TEST_CASE("Testing hinted insert and find in avl tree"){
+  avl_tree<int> t;
+  auto it = t.cend();
+  for(int i = 0; i < 256; i++){
+    auto [pos, inserted] = t.insert(it, i);
+    REQUIRE(inserted == true);
+    REQUIRE(*pos == i);
+    it = pos;
+  }
+  REQUIRE(t.size() == 256);
+  REQUIRE(t.level_order().size() == 9);
+  REQUIRE(t.insert(it, 17).second == false);
+  REQUIRE(*t.find(it, 17) == 17);
+  REQUIRE(t.find(it, 300) == t.cend());
+  int expected = 0;
+  for(auto curr = t.cbegin(); curr != t.cend(); ++curr){
+    REQUIRE(*curr == expected++);
+  }
+  REQUIRE(expected == 256);
+  t.remove(100);
+  REQUIRE(*t.find(it, 101) == 101);
+  REQUIRE(t.find(it, 100) == t.cend());
+}
+
+TEST_CASE("Testing append and join in avl tree"){
+  avl_tree<int> t;
+  for(int i = 0; i < 1000; i++){
+    auto [it, appended] = t.append(i);
+    REQUIRE(appended == true);
+    REQUIRE(*it == i);
+  }
+  REQUIRE(t.append(500).second == false);
+  REQUIRE(t.append(-1).second == false);
+  REQUIRE(t.size() == 1000);
+  REQUIRE(t.level_order().size() <= 14);
+  REQUIRE(*t.last() == 999);
+
+  avl_tree<int> right;
+  for(int i = 2000; i < 2010; i++){
+    right.append(i);
+  }
+  avl_tree<int> joined = avl_tree<int>::join(std::move(t), 1500, std::move(right));
+  REQUIRE(t.size() == 0);
+  REQUIRE(right.size() == 0);
+  REQUIRE(joined.size() == 1011);
+  REQUIRE(joined.level_order().size() <= 14);
+  std::vector<int> v = joined.inorder();
+  REQUIRE(std::is_sorted(v.begin(), v.end()));
+  REQUIRE(v.size() == 1011);
+  REQUIRE(joined.search(1500));
+  REQUIRE(joined.remove(1500));
+  REQUIRE(*joined.lower_bound(1000) == 2000);
+}
+
+TEST_CASE("Testing rank and select in avl tree"){
+  avl_tree<int> t;
+  for(int i = 0; i < 200; i++){
+    t.insert((i * 37) % 200 * 2);
+  }
+  for(int i = 0; i < 200; i += 3){
+    t.remove(i * 2);
+  }
+  std::vector<int> v = t.inorder();
+  for(size_t k = 0; k < v.size(); k++){
+    REQUIRE(*t.select(k) == v[k]);
+    REQUIRE(t.rank(v[k]) == k);
+    REQUIRE(t.rank(v[k] + 1) == k + 1);
+  }
+  REQUIRE(t.select(v.size()) == t.cend());
+  REQUIRE(t.rank(-1) == 0);
+}
+
+TEST_CASE("Testing aggregates in avl tree"){
+  avl_tree<int, std::less<>, std::identity{}, sum_min_max<int64_t>> t;
+  for(int i = 1; i <= 100; i++){
+    t.insert((i * 37) % 101);
+  }
+  for(int i = 0; i < 101; i += 4){
+    t.remove(i);
+  }
+  std::vector<int> v = t.inorder();
+  int64_t total = 0;
+  for(int x : v){
+    total += x;
+  }
+  REQUIRE(t.aggregate().sum == total);
+  REQUIRE(t.aggregate().min == v.front());
+  REQUIRE(t.aggregate().max == v.back());
+  for(int a = 0; a < 101; a += 7){
+    for(int b = a; b < 110; b += 11){
+      int64_t sum = 0;
+      int64_t max = std::numeric_limits<int64_t>::lowest();
+      for(int x : v){
+        if(x >= a && x < b){
+          sum += x;
+          max = std::max<int64_t>(max, x);
+        }
+      }
+      REQUIRE(t.aggregate(a, b).sum == sum);
+      REQUIRE(t.aggregate(a, b).max == max);
+    }
+    REQUIRE(t.aggregate_below(a).sum + t.aggregate_from(a).sum == total);
+  }
+}
+
+TEST_CASE("Testing pop_min and pop_max in avl tree"){
+  avl_tree<int> t;
+  for(int i = 0; i < 100; i++){
+    t.insert((i * 31) % 100);
+  }
+  for(int i = 0; i < 25; i++){
+    REQUIRE(t.pop_min() == i);
+    REQUIRE(t.pop_max() == 99 - i);
+  }
+  REQUIRE(t.size() == 50);
+  REQUIRE(*t.first() == 25);
+  REQUIRE(*t.last() == 74);
+  REQUIRE(t.rank(50) == 25);
+  REQUIRE(t.level_order().size() <= 7);
+}
+
+TEST_CASE("Testing extract and node insert in avl tree"){
+  avl_tree<int> t;
+  for(int i = 0; i < 50; i++){
+    t.insert(i);
+  }
+  auto nh = t.extract_min();
+  REQUIRE(nh.empty() == false);
+  REQUIRE(nh.value() == 0);
+  REQUIRE(t.size() == 49);
+  const int *address = &nh.value();
+  nh.value() = 100;
+  auto result = t.insert(std::move(nh));
+  REQUIRE(result.inserted == true);
+  REQUIRE(result.node.empty() == true);
+  REQUIRE(&*result.position == address);
+  REQUIRE(*t.last() == 100);
+  REQUIRE(t.rank(100) == 49);
+
+  auto big = t.extract_max();
+  REQUIRE(big.value() == 100);
+  big.value() = 10;
+  result = t.insert(std::move(big));
+  REQUIRE(result.inserted == false);
+  REQUIRE(*result.position == 10);
+  REQUIRE(result.node.value() == 10);
+  REQUIRE(t.size() == 49);
+  REQUIRE(t.level_order().size() <= 6);
+}
+
+TEST_CASE("Testing erase and erase_if in avl tree"){
+  avl_tree<int> t;
+  for(int i = 0; i < 1000; i++){
+    t.insert(i);
+  }
+  REQUIRE(t.erase(100, 900) == 800);
+  REQUIRE(t.size() == 200);
+  REQUIRE(t.search(99) == true);
+  REQUIRE(t.search(100) == false);
+  REQUIRE(t.search(900) == true);
+  REQUIRE(t.erase_below(50) == 50);
+  REQUIRE(t.erase_from(950) == 50);
+  REQUIRE(*t.first() == 50);
+  REQUIRE(*t.last() == 949);
+  REQUIRE(t.rank(900) == 50);
+  REQUIRE(t.level_order().size() <= 9);
+  REQUIRE(t.erase_if([](int key) { return key % 2 == 0; }) == 50);
+  REQUIRE(t.size() == 50);
+  REQUIRE(*t.first() == 51);
+  REQUIRE(*t.select(49) == 949);
+  REQUIRE(t.level_order().size() <= 6);
+}
+
+TEST_CASE("Testing split and join without a pivot in avl tree"){
+  avl_tree<int> t;
+  for(int i = 0; i < 1000; i++){
+    t.insert(i);
+  }
+  avl_tree<int> upper = t.split(600);
+  REQUIRE(t.size() == 600);
+  REQUIRE(upper.size() == 400);
+  REQUIRE(*t.last() == 599);
+  REQUIRE(*upper.first() == 600);
+  REQUIRE(upper.rank(999) == 399);
+  REQUIRE(t.level_order().size() <= 12);
+  REQUIRE(upper.level_order().size() <= 12);
+  REQUIRE(t.split(-5).size() == 600);
+  REQUIRE(t.size() == 0);
+
+  avl_tree<int> low, high;
+  for(int i = 0; i < 10; i++){
+    low.insert(i);
+  }
+  for(int i = 100; i < 1000; i++){
+    high.insert(i);
+  }
+  avl_tree<int> joined = avl_tree<int>::join(std::move(low), std::move(high));
+  REQUIRE(joined.size() == 910);
+  REQUIRE(low.size() == 0);
+  REQUIRE(*joined.select(10) == 100);
+  REQUIRE(joined.level_order().size() <= 12);
+}
+
+TEST_CASE("Testing extract by key in avl tree"){
+  avl_tree<int> t;
+  for(int i = 0; i < 100; i++){
+    t.insert(i);
+  }
+  const int *address = &*t.find(50);
+  auto nh = t.extract(50);
+  REQUIRE(nh.empty() == false);
+  REQUIRE(&nh.value() == address);
+  REQUIRE(t.size() == 99);
+  REQUIRE(t.search(50) == false);
+  REQUIRE(t.extract(50).empty() == true);
+  REQUIRE(*t.find(51) == 51);
+  REQUIRE(t.rank(99) == 98);
+  for(int i = 0; i < 100; i += 3){
+    t.extract(i);
+  }
+  REQUIRE(t.size() == 65);
+  REQUIRE(t.level_order().size() <= 8);
+  nh.value() = 1000;
+  REQUIRE(t.insert(std::move(nh)).inserted == true);
+  REQUIRE(*t.last() == 1000);
+}
+
+TEST_CASE("Testing extract by key from a copy in avl tree"){
+  avl_tree<int> t;
+  for(int i = 0; i < 100; i++){
+    t.insert(i);
+  }
+  avl_tree<int> copy(t);
+  std::vector<int> before = t.inorder();
+  const int *address = &*t.find(50);
+  for(int i = 0; i < 100; i += 2){
+    auto nh = copy.extract(i);
+    REQUIRE(nh.value() == i);
+    // the node is still shared with t, so a copy is handed out
+    REQUIRE(&nh.value() != &*t.find(i));
+  }
+  REQUIRE(copy.size() == 50);
+  REQUIRE(copy.rank(51) == 25);
+  REQUIRE(t.inorder() == before);
+  REQUIRE(&*t.find(50) == address);
+}
+
+TEST_CASE("Testing copies that share nodes in avl tree"){
+  avl_tree<int> t;
+  for(int i = 0; i < 200; i++){
+    t.insert(i);
+  }
+  avl_tree<int> copy(t);
+  std::vector<int> before = t.inorder();
+  const int *address = &*t.find(150);
+  copy.insert(1000);
+  copy.remove(10);
+  copy.pop_min();
+  copy.pop_max();
+  copy.erase_below(50);
+  copy.erase_if([](int x){ return x % 2 == 0; });
+  avl_tree<int> high = copy.split(120);
+  REQUIRE(t.inorder() == before);
+  REQUIRE(&*t.find(150) == address);
+  REQUIRE(copy.size() == 35);
+  REQUIRE(high.size() == 40);
+  REQUIRE(*copy.select(0) == 51);
+  REQUIRE(*high.last() == 199);
+  t.remove(150);
+  REQUIRE(high.search(151) == true);
+  REQUIRE(high.search(150) == false);
+  REQUIRE(t.size() == 199);
+  REQUIRE(t.level_order().size() <= 9);
+}
+
+TEST_CASE("Testing iterators deeper than their window in avl tree"){
+  REQUIRE(sizeof(avl_tree<int>::const_iterator) <= 128);
+  avl_tree<int> t;
+  for(int i = 0; i < 100000; i++){
+    t.append(i);
+  }
+  REQUIRE(t.level_order().size() > 16);
+  int expected = 0;
+  for(auto curr = t.cbegin(); curr != t.cend(); ++curr){
+    REQUIRE(*curr == expected++);
+  }
+  REQUIRE(expected == 100000);
+  auto it = t.cend();
+  for(int i = 99999; i >= 0; i--){
+    REQUIRE(*--it == i);
+  }
+  REQUIRE(it == t.cbegin());
+  auto mid = t.find(54321);
+  REQUIRE(*t.find(mid, 12345) == 12345);
+  REQUIRE(*t.find(mid, 54322) == 54322);
+  REQUIRE(t.find(mid, 100000) == t.cend());
+  auto bound = t.lower_bound(777);
+  REQUIRE(*++bound == 778);
+  REQUIRE(*----bound == 776);
+}
@@ -2,6 +2,8 @@
 #include "../src/bubble.h"
 #include <string>
 #include <cmath>
+#include <iterator>
+#include <set>
 
 TEST_CASE("Testing insertion for bubble class") {
     bubble<int, 5> b;
@@ -19,6 +21,20 @@ TEST_CASE("Testing insertion for bubble class") {
     REQUIRE(b.search(-10) == true);
 }
 
+TEST_CASE("Testing insertion before the array is full") {
+    bubble<int, 5> b;
+    b.insert(50, 10, 30, 10);
+    REQUIRE(b.size() == 3);
+    REQUIRE(b[0].first == 10);
+    REQUIRE(b[1].first == 30);
+    REQUIRE(b[2].first == 50);
+    REQUIRE(b.search(10) == true);
+    REQUIRE(b.search(30) == true);
+    b.insert(40, 20, 25);
+    REQUIRE(b.get_key(1) == 20);
+    REQUIRE(b.search(25) == true);
+}
+
 TEST_CASE("Testing searching for bubble class") {
     bubble<std::string, 5> b;
 
@@ -67,9 +83,14 @@ TEST_CASE("Testing removing for bubble class") {
     b2.insert(-50, -20, 0, 20, 50);
     b2.insert(35, 30, 38, 36, 45, 22);
     b2.remove(20);
-    REQUIRE(b2[3].first == 35);
+    REQUIRE(b2[3].first == 22);
+    REQUIRE(b2.search(30) == true);
     b2.remove(35);
-    REQUIRE(b2[3].first == 36);
+    REQUIRE(b2[3].first == 22);
+    REQUIRE(b2.search(35) == false);
+    b2.remove(22);
+    REQUIRE(b2[3].first == 30);
+    REQUIRE(b2.size() == 8);
 }
 
 TEST_CASE("Testing size for bubble class") {
@@ -83,6 +104,18 @@ TEST_CASE("Testing size for bubble class") {
     REQUIRE(b.size() == 0);
 }
 
+TEST_CASE("Testing size with duplicates and missing keys") {
+    bubble<int, 3> b;
+    b.insert(10, 20, 30, 15, 25, 35);
+    b.insert(15, 25, 35, 10);
+    REQUIRE(b.size() == 6);
+    b.remove(16, 26, 40);
+    REQUIRE(b.size() == 6);
+    b.remove(15, 15);
+    REQUIRE(b.size() == 5);
+    REQUIRE(b.search(15) == false);
+}
+
 TEST_CASE("Testing empty for bubble class") {
     bubble<int, 10> b;
     REQUIRE(b.empty() == true);
@@ -123,7 +156,8 @@ TEST_CASE("Testing copy constructor for bubble class") {
     }
 
     bubble<int, 6> b3(b);
-    REQUIRE(b3.size() == 0);
+    REQUIRE(b3.size() == 11);
+    REQUIRE(std::vector<int>(b3.cbegin(), b3.cend()) == std::vector<int>(b.cbegin(), b.cend()));
 }
 
 TEST_CASE("Testing get_key function for bubble class") {
@@ -316,3 +350,641 @@ TEST_CASE("Testint operators [2]") {
     REQUIRE(!(b1[0] > b2[0]));
     REQUIRE(!(b1[0] < b2[0]));
 }
+
+TEST_CASE("Testing custom comparator for bubble") {
+    bubble<int, 3, std::greater<>> b;
+    b.insert(10, 20, 30);
+    REQUIRE(b.get_key(0) == 30);
+    REQUIRE(b.get_key(2) == 10);
+    b.insert(25, 15, 5, 35);
+    REQUIRE(b.size() == 7);
+    REQUIRE(b[0].second == std::vector<int>{35, 25});
+    REQUIRE(b[1].second == std::vector<int>{15});
+    REQUIRE(b[2].second == std::vector<int>{5});
+    b.remove(30);
+    REQUIRE(b.search(30) == false);
+    REQUIRE(b.search(35) == true);
+}
+
+namespace {
+    struct order {
+        int64_t id;
+        std::string customer;
+        double amount;
+    };
+}
+
+TEST_CASE("Testing key projection for bubble") {
+    bubble<order, 3, std::less<>, &order::id> b;
+    b.insert(order{20, "b", 2.0}, order{10, "a", 1.0}, order{30, "c", 3.0});
+    b.insert(order{25, "d", 4.0}, order{5, "e", 5.0});
+    b.insert(order{25, "duplicate", 0.0});
+    REQUIRE(b.size() == 5);
+    REQUIRE(b.get_key(0).id == 10);
+    REQUIRE(b.search(25) == true);
+    REQUIRE(b.search(5) == true);
+    REQUIRE(b.search(15) == false);
+    REQUIRE(b.get_tree(1).inorder()[0].customer == "d");
+    b.remove(20);
+    REQUIRE(b.get_key(1).id == 25);
+    REQUIRE(b.search(20) == false);
+    REQUIRE(b.size() == 4);
+}
+
+TEST_CASE("Testing bucket operators under comparator and projection") {
+    using tree = avl_tree<order, std::greater<>, &order::id>;
+    using bucket = std::pair<order, std::optional<tree>>;
+    bucket a{order{10, "a", 1.0}, std::nullopt}, b{order{10, "b", 2.0}, std::nullopt};
+    REQUIRE(a == b);
+    REQUIRE(!(a < b));
+    bucket c{order{5, "c", 3.0}, std::nullopt};
+    REQUIRE(a < c);
+    REQUIRE(c >= a);
+
+    a.second = tree(std::vector<order>{order{3, "x", 0.0}, order{2, "y", 0.0}});
+    b.second = tree(std::vector<order>{order{3, "z", 0.0}, order{1, "w", 0.0}});
+    REQUIRE(b > a);
+    REQUIRE(a != b);
+    b.second = tree(std::vector<order>{order{3, "z", 0.0}});
+    REQUIRE(b < a);
+    REQUIRE(b <= a);
+    b.second->insert(order{2, "w", 0.0});
+    REQUIRE(a == b);
+    REQUIRE(bucket{order{10, "d", 0.0}, std::nullopt} < a);
+}
+
+TEST_CASE("Testing three-way comparator for bubble") {
+    bubble<std::string, 3, std::compare_three_way> b;
+    b.insert("https://a.com/1", "https://a.com/5", "https://a.com/9");
+    b.insert("https://a.com/2", "https://a.com/6", "https://a.com/0");
+    REQUIRE(b.size() == 6);
+    REQUIRE(b.search("https://a.com/6") == true);
+    REQUIRE(b.search("https://a.com/7") == false);
+    b.remove("https://a.com/5");
+    REQUIRE(b.get_key(1) == "https://a.com/6");
+    REQUIRE(b.search("https://a.com/0") == true);
+}
+
+TEST_CASE("Testing find and const_iterator for bubble") {
+    bubble<int, 3> b;
+    REQUIRE(b.cbegin() == b.cend());
+    b.insert(20, 10, 30);
+    b.insert(5, 15, 12, 25, 40, 35, 1);
+    std::vector<int> check {1, 5, 10, 12, 15, 20, 25, 30, 35, 40};
+    std::vector<int> walked;
+    for(auto it = b.cbegin(); it != b.cend(); it++){
+        walked.push_back(*it);
+    }
+    REQUIRE(walked == check);
+
+    std::vector<int> reversed;
+    auto it = b.cend();
+    while(it != b.cbegin()) {
+        --it;
+        reversed.push_back(*it);
+    }
+    REQUIRE(reversed == std::vector<int>(check.rbegin(), check.rend()));
+
+    REQUIRE(*b.find(12) == 12);
+    REQUIRE(*(++b.find(12)) == 15);
+    REQUIRE(*(--b.find(10)) == 5);
+    REQUIRE(b.find(13) == b.cend());
+}
+
+TEST_CASE("Testing insert and remove results for bubble") {
+    bubble<int, 3> b;
+    auto [it, inserted] = b.insert(10);
+    REQUIRE(inserted == true);
+    REQUIRE(*it == 10);
+    REQUIRE(b.insert(10).second == false);
+    REQUIRE(b.insert(20, 30, 40, 20, 50) == 4);
+    auto [dup, fresh] = b.insert(40);
+    REQUIRE(fresh == false);
+    REQUIRE(*dup == 40);
+    REQUIRE(*(++dup) == 50);
+
+    REQUIRE(b.remove(10) == 1);
+    REQUIRE(b.remove(10) == 0);
+    REQUIRE(b.remove(20, 30, 60) == 2);
+    REQUIRE(b.size() == 2);
+}
+
+TEST_CASE("Testing find_or_insert for bubble") {
+    bubble<order, 3, std::less<>, &order::id> b;
+    int created {0};
+    auto make = [&](int64_t id) {
+        return [&, id]() {
+            created++;
+            return order{id, "customer", 1.0};
+        };
+    };
+    for(int64_t id : {10, 20, 30, 40, 10, 25, 40}){
+        b.find_or_insert(id, make(id));
+    }
+    REQUIRE(created == 5);
+    REQUIRE(b.size() == 5);
+    auto [it, inserted] = b.find_or_insert(25, make(25));
+    REQUIRE(inserted == false);
+    REQUIRE(it->id == 25);
+    REQUIRE(created == 5);
+}
+
+TEST_CASE("Testing hinted insert and find for bubble") {
+    bubble<int, 4> b;
+    std::set<int> expected;
+    auto it = b.cend();
+    for(int i = 0; i < 400; i++) {
+        // nearly sorted keys, every tenth one jumps back
+        int key = i % 10 == 9 ? i - 37 : i;
+        auto [pos, inserted] = b.insert(it, key);
+        REQUIRE(*pos == key);
+        REQUIRE(inserted == expected.insert(key).second);
+        it = pos;
+    }
+    REQUIRE(b.size() == expected.size());
+    REQUIRE(std::equal(b.cbegin(), b.cend(), expected.begin(), expected.end()));
+    REQUIRE(std::equal(std::make_reverse_iterator(b.cend()), std::make_reverse_iterator(b.cbegin()),
+                       expected.rbegin(), expected.rend()));
+
+    auto hint = b.find(200);
+    REQUIRE(*b.find(hint, 203) == 203);
+    REQUIRE(*b.find(hint, 2) == 2);
+    REQUIRE(b.find(hint, 1000) == b.cend());
+    // a hint from before a removal is ignored instead of followed
+    b.remove(200);
+    REQUIRE(*b.find(hint, 201) == 201);
+    REQUIRE(b.insert(hint, 200).second == true);
+    REQUIRE(b.find(b.cend(), 200) != b.cend());
+}
+
+TEST_CASE("Testing append for bubble") {
+    bubble<int, 8> b;
+    for(int i = 0; i < 5000; i++) {
+        auto [it, inserted] = b.append(i * 2);
+        REQUIRE(inserted == true);
+        REQUIRE(*it == i * 2);
+    }
+    REQUIRE(b.size() == 5000);
+    REQUIRE(b.array_size() == 8);
+    // the keys are spread over the buckets instead of piling up in the last one
+    for(size_t i = 0; i < b.array_size(); i++) {
+        REQUIRE(b.get_tree(i).size() < 5000 / 2);
+    }
+    // keys that are not the biggest fall back to a normal insert
+    REQUIRE(b.append(4000).second == false);
+    REQUIRE(b.append(4001).second == true);
+    REQUIRE(b.size() == 5001);
+    int prev = -1;
+    for(auto it = b.cbegin(); it != b.cend(); ++it) {
+        REQUIRE(*it > prev);
+        prev = *it;
+    }
+    REQUIRE(b.search(9998));
+    REQUIRE(b.remove(9998) == 1);
+    REQUIRE(*(--b.cend()) == 9996);
+}
+
+TEST_CASE("Testing range queries for bubble") {
+    static_assert(std::bidirectional_iterator<bubble<int, 4>::const_iterator>);
+    bubble<int, 4> b;
+    for(int i = 0; i < 100; i += 5) {
+        b.insert(i);
+    }
+    // 0, 5, 10 and 15 are the pivots, everything else lives in the trees
+    b.insert(-7, -3);
+    REQUIRE(*b.lower_bound(-10) == -7);
+    REQUIRE(*b.lower_bound(-5) == -3);
+    REQUIRE(*b.lower_bound(-1) == 0);
+    REQUIRE(*b.lower_bound(5) == 5);
+    REQUIRE(*b.lower_bound(16) == 20);
+    REQUIRE(*b.lower_bound(95) == 95);
+    REQUIRE(b.lower_bound(96) == b.cend());
+    REQUIRE(*b.upper_bound(5) == 10);
+    REQUIRE(*b.upper_bound(14) == 15);
+    REQUIRE(*b.upper_bound(-3) == 0);
+    REQUIRE(b.upper_bound(95) == b.cend());
+
+    auto [first, last] = b.equal_range(40);
+    REQUIRE(*first == 40);
+    REQUIRE(*last == 45);
+    auto [none, same] = b.equal_range(41);
+    REQUIRE(none == same);
+
+    REQUIRE(*b.predecessor(40) == 35);
+    REQUIRE(*b.predecessor(41) == 40);
+    REQUIRE(*b.predecessor(0) == -3);
+    REQUIRE(b.predecessor(-7) == b.cend());
+    REQUIRE(*b.successor(-3) == 0);
+    REQUIRE(*b.successor(12) == 15);
+
+    std::vector<int> in_range;
+    for(int key : b.range(-5, 31)) {
+        in_range.push_back(key);
+    }
+    REQUIRE(in_range == std::vector<int>{-3, 0, 5, 10, 15, 20, 25, 30});
+    REQUIRE(std::ranges::distance(b.range(12, 13)) == 0);
+    REQUIRE(std::ranges::distance(b.range(50, 20)) == 0);
+    REQUIRE(std::ranges::distance(b.range(-100, 100)) == 22);
+    REQUIRE(bubble<int, 4>().range(0, 10).empty());
+}
+
+TEST_CASE("Testing rank, select and count for bubble") {
+    bubble<int, 8> b;
+    std::set<int> expected;
+    for(int i = 0; i < 500; i++) {
+        int key = (i * 7919) % 1000 - 100;
+        b.insert(key);
+        expected.insert(key);
+        if(i % 4 == 0) {
+            b.remove(key / 2);
+            expected.erase(key / 2);
+        }
+    }
+    std::vector<int> sorted(expected.begin(), expected.end());
+    for(size_t k = 0; k < sorted.size(); k++) {
+        REQUIRE(*b.select(k) == sorted[k]);
+        REQUIRE(b.rank(sorted[k]) == k);
+        REQUIRE(b.rank(sorted[k] + 1) == k + 1);
+    }
+    REQUIRE(b.select(sorted.size()) == b.cend());
+    REQUIRE(b.rank(-1000) == 0);
+    REQUIRE(b.count(-1000, 1000) == sorted.size());
+    REQUIRE(b.count(0, 100) == static_cast<size_t>(std::distance(expected.lower_bound(0), expected.lower_bound(100))));
+    REQUIRE(b.count(100, 0) == 0);
+
+    // appended keys keep the counts current
+    for(int i = 1000; i < 1100; i++) {
+        b.append(i);
+    }
+    REQUIRE(b.rank(1050) == sorted.size() + 50);
+    REQUIRE(*b.select(sorted.size() + 99) == 1099);
+}
+
+TEST_CASE("Testing range aggregates for bubble") {
+    bubble<order, 8, std::less<>, &order::id, sum_min_max<double, &order::amount>> b;
+    std::vector<order> orders;
+    for(int64_t id = 0; id < 300; id++) {
+        orders.push_back(order{(id * 101) % 300, "customer", static_cast<double>((id * 7) % 50)});
+    }
+    for(auto && o : orders) {
+        b.insert(o);
+    }
+    for(int64_t id = 0; id < 300; id += 5) {
+        b.remove(id);
+    }
+    for(int64_t id = 300; id < 400; id++) {
+        b.append(order{id, "customer", 1.0});
+    }
+    auto amount = [&](int64_t id) {
+        if(id >= 300) { return 1.0; }
+        for(auto && o : orders) {
+            if(o.id == id) { return o.amount; }
+        }
+        return 0.0;
+    };
+    for(int64_t first = -10; first < 410; first += 23) {
+        for(int64_t last = first; last < 420; last += 37) {
+            double sum = 0;
+            for(int64_t id = std::max<int64_t>(first, 0); id < std::min<int64_t>(last, 400); id++) {
+                if(id % 5 != 0 || id >= 300) { sum += amount(id); }
+            }
+            REQUIRE(b.sum(first, last) == sum);
+        }
+        std::optional<double> max;
+        for(int64_t id = 0; id < std::min<int64_t>(first, 400); id++) {
+            if(id % 5 != 0 || id >= 300) { max = std::max(max.value_or(0), amount(id)); }
+        }
+        REQUIRE(b.max_below(first) == max);
+    }
+    REQUIRE(b.aggregate(50, 50).sum == 0);
+}
+
+TEST_CASE("Testing min, max, pop_min and pop_max for bubble") {
+    bubble<int, 4> b;
+    std::multiset<int> expected;
+    for(int i = 0; i < 200; i++) {
+        int key = (i * 53) % 211;
+        b.insert(key);
+        expected.insert(key);
+        REQUIRE(b.min() == *expected.begin());
+        REQUIRE(b.max() == *expected.rbegin());
+    }
+    b.insert(-5);
+    REQUIRE(b.min() == -5);
+    b.append(500);
+    REQUIRE(b.max() == 500);
+    REQUIRE(b.pop_max() == 500);
+    REQUIRE(b.pop_min() == -5);
+    while(!b.empty()) {
+        REQUIRE(b.pop_min() == *expected.begin());
+        expected.erase(expected.begin());
+        if(expected.empty()) { break; }
+        REQUIRE(b.pop_max() == *expected.rbegin());
+        expected.erase(std::prev(expected.end()));
+    }
+    REQUIRE(b.size() == 0);
+    REQUIRE(expected.empty());
+}
+
+TEST_CASE("Testing a scheduler queue that keeps growing past the last pivot") {
+    bubble<int, 16> b;
+    std::set<int> expected;
+    for(int i = 0; i < 64; i++) {
+        b.insert(i * 10);
+        expected.insert(i * 10);
+    }
+    for(int now = 0; now < 5000; now++) {
+        REQUIRE(b.pop_min() == *expected.begin());
+        expected.erase(expected.begin());
+        int key = 700 + now * 10 + now % 7;
+        REQUIRE(b.insert(key).second == true);
+        expected.insert(key);
+        REQUIRE(*b.find(key) == key);
+        REQUIRE(b.min() == *expected.begin());
+        REQUIRE(b.max() == *expected.rbegin());
+    }
+    // the keys no longer pile up in the last bucket
+    REQUIRE(b.pivots() > 1);
+    REQUIRE(b.size() == expected.size());
+    REQUIRE(b.rank(*std::next(expected.begin(), 30)) == 30);
+    std::vector<int> keys(b.cbegin(), b.cend());
+    REQUIRE(keys == std::vector<int>(expected.begin(), expected.end()));
+}
+
+TEST_CASE("Testing erase, erase_below and erase_if for bubble") {
+    bubble<int, 8> b;
+    std::set<int> expected;
+    for(int i = 0; i < 500; i++) {
+        int key = (i * 37) % 503;
+        b.insert(key);
+        expected.insert(key);
+    }
+    REQUIRE(b.erase_below(100) == 100);
+    expected.erase(expected.begin(), expected.lower_bound(100));
+    REQUIRE(b.min() == 100);
+    REQUIRE(b.erase(200, 300) == 100);
+    expected.erase(expected.lower_bound(200), expected.lower_bound(300));
+    REQUIRE(b.search(199) == true);
+    REQUIRE(b.search(200) == false);
+    REQUIRE(b.search(300) == true);
+    REQUIRE(b.erase(300, 200) == 0);
+    REQUIRE(b.erase_if([](int key) { return key % 3 == 0; }) == std::erase_if(expected, [](int key) { return key % 3 == 0; }));
+    REQUIRE(b.size() == expected.size());
+    REQUIRE(std::vector<int>(b.cbegin(), b.cend()) == std::vector<int>(expected.begin(), expected.end()));
+    REQUIRE(b.rank(b.max()) == b.size() - 1);
+    REQUIRE(b.erase_below(1000) == expected.size());
+    REQUIRE(b.empty());
+    b.insert(1, 2, 3);
+    REQUIRE(b.size() == 3);
+    REQUIRE(b.min() == 1);
+}
+
+TEST_CASE("Testing split and concat for bubble") {
+    bubble<int, 8> b;
+    for(int i = 0; i < 1000; i++) {
+        b.insert((i * 7) % 1000);
+    }
+    bubble<int, 8> upper = b.split(250);
+    REQUIRE(b.size() == 250);
+    REQUIRE(upper.size() == 750);
+    REQUIRE(b.max() == 249);
+    REQUIRE(upper.min() == 250);
+    REQUIRE(upper.rank(500) == 250);
+    REQUIRE(b.split(2000).empty());
+
+    bubble<int, 8> lower = b.split(-1);
+    REQUIRE(b.empty());
+    REQUIRE(lower.size() == 250);
+
+    lower.insert(600);
+    REQUIRE(upper.concat(std::move(lower)) == false);
+    REQUIRE(lower.size() == 251);
+    lower.remove(600);
+    REQUIRE(upper.concat(std::move(lower)) == true);
+    REQUIRE(lower.empty());
+    REQUIRE(upper.size() == 1000);
+    REQUIRE(upper.pivots() <= 8);
+    std::vector<int> keys(upper.cbegin(), upper.cend());
+    for(int i = 0; i < 1000; i++) {
+        REQUIRE(keys[i] == i);
+    }
+    REQUIRE(*upper.select(500) == 500);
+}
+
+TEST_CASE("Testing concat of two full bubbles") {
+    bubble<int, 16> a, b;
+    for(int i = 0; i < 4000; i++) {
+        if(i < 2000) { a.insert((i * 37) % 2000); }
+        else { b.insert(2000 + (i * 37) % 2000); }
+    }
+    REQUIRE(a.pivots() == 16);
+    REQUIRE(b.pivots() == 16);
+    REQUIRE(a.concat(std::move(b)) == true);
+    REQUIRE(a.pivots() == 16);
+    REQUIRE(a.size() == 4000);
+    std::vector<int> keys(a.cbegin(), a.cend());
+    for(int i = 0; i < 4000; i++) {
+        REQUIRE(keys[i] == i);
+    }
+    REQUIRE(a.rank(3000) == 3000);
+    REQUIRE(a.remove(0) == 1);
+    REQUIRE(a.min() == 1);
+}
+
+TEST_CASE("Testing set_union, set_intersection and set_difference for bubble") {
+    bubble<int, 16> a, b;
+    std::set<int> in_a, in_b;
+    for(int i = 0; i < 60000; i++) {
+        int key = (i * 7919) % 100003;
+        if(i % 3 != 0) { a.insert(key); in_a.insert(key); }
+        if(i % 2 != 0) { b.insert(key); in_b.insert(key); }
+    }
+    for(size_t threads : {1, 4}) {
+        std::vector<int> expected;
+        std::set_union(in_a.begin(), in_a.end(), in_b.begin(), in_b.end(), std::back_inserter(expected));
+        bubble<int, 16> result = bubble<int, 16>::set_union(a, b, threads);
+        REQUIRE(std::vector<int>(result.cbegin(), result.cend()) == expected);
+        REQUIRE(result.pivots() <= 16);
+
+        expected.clear();
+        std::set_intersection(in_a.begin(), in_a.end(), in_b.begin(), in_b.end(), std::back_inserter(expected));
+        result = bubble<int, 16>::set_intersection(a, b, threads);
+        REQUIRE(std::vector<int>(result.cbegin(), result.cend()) == expected);
+        REQUIRE(result.rank(expected.back()) == expected.size() - 1);
+
+        expected.clear();
+        std::set_difference(in_a.begin(), in_a.end(), in_b.begin(), in_b.end(), std::back_inserter(expected));
+        result = bubble<int, 16>::set_difference(a, b, threads);
+        REQUIRE(std::vector<int>(result.cbegin(), result.cend()) == expected);
+        REQUIRE(result.size() == expected.size());
+    }
+    bubble<int, 16> empty;
+    REQUIRE(bubble<int, 16>::set_intersection(a, empty).empty());
+    REQUIRE(bubble<int, 16>::set_union(empty, b).size() == b.size());
+}
+
+TEST_CASE("Testing extract, node insert and merge for bubble") {
+    bubble<int, 4> a, b;
+    for(int i = 0; i < 100; i++) {
+        a.insert(i);
+    }
+    auto nh = a.extract(57);
+    REQUIRE(nh.value() == 57);
+    REQUIRE(a.size() == 99);
+    REQUIRE(a.search(57) == false);
+    REQUIRE(a.extract(57).empty() == true);
+    auto result = b.insert(std::move(nh));
+    REQUIRE(result.inserted == true);
+    REQUIRE(*result.position == 57);
+
+    int pivot = a[1].first;
+    auto moved = a.extract(pivot);
+    REQUIRE(moved.value() == pivot);
+    REQUIRE(a.search(pivot) == false);
+    REQUIRE(a.size() == 98);
+
+    b.insert(101, 102, 103, 104, 105);
+    auto back = b.extract(57);
+    back.value() = 103;
+    result = b.insert(std::move(back));
+    REQUIRE(result.inserted == false);
+    REQUIRE(result.node.value() == 103);
+
+    b.insert(pivot, 10, 200);
+    a.merge(b);
+    REQUIRE(a.size() == 105);
+    REQUIRE(a.search(pivot) == true);
+    REQUIRE(a.max() == 200);
+    REQUIRE(std::vector<int>(b.cbegin(), b.cend()) == std::vector<int>{10});
+    REQUIRE(*a.select(99) == 101);
+
+    bubble<int, 4> high;
+    high.insert(300, 400);
+    a.merge(high);
+    REQUIRE(high.empty());
+    REQUIRE(a.max() == 400);
+
+    // past the fill phase the node itself moves between the bubbles
+    bubble<int, 4> full;
+    for(int i = 1000; i < 1010; i++) {
+        full.insert(i);
+    }
+    const int* address = &*a.find(50);
+    auto relinked = full.insert(a.extract(50));
+    REQUIRE(relinked.inserted == true);
+    REQUIRE(&*relinked.position == address);
+}
+
+TEST_CASE("Testing take for bubble") {
+    bubble<std::string, 4> b;
+    for(int i = 0; i < 40; i++) { b.insert(std::to_string(i * 7 % 40)); }
+    std::string pivot = b.get_key(1);
+    REQUIRE(b.take(pivot) == pivot);
+    REQUIRE(b.search(pivot) == false);
+    REQUIRE(b.take(pivot) == std::nullopt);
+    for(int i = 0; i < 40; i++) {
+        std::string key = std::to_string(i);
+        if(key == pivot) { continue; }
+        REQUIRE(b.take(key) == key);
+        REQUIRE(b.size() == static_cast<size_t>(38 - i + (i > std::stoi(pivot))));
+    }
+    REQUIRE(b.empty() == true);
+    REQUIRE(b.take("0") == std::nullopt);
+}
+
+TEST_CASE("Testing conversion between bubbles of different sizes") {
+    bubble<int, 8> small;
+    for(int i = 0; i < 5000; i++) {
+        small.insert((i * 13) % 5000);
+    }
+    bubble<int, 64> large(small);
+    REQUIRE(large.size() == 5000);
+    REQUIRE(large.pivots() == 64);
+    REQUIRE(std::vector<int>(large.cbegin(), large.cend()) == std::vector<int>(small.cbegin(), small.cend()));
+    REQUIRE(large.rank(2500) == 2500);
+    REQUIRE(large.insert(5000).second == true);
+    REQUIRE(large.remove(0) == 1);
+
+    bubble<int, 4> tiny;
+    tiny = large;
+    REQUIRE(tiny.size() == 5000);
+    REQUIRE(tiny.pivots() == 4);
+    REQUIRE(tiny.min() == 1);
+    REQUIRE(tiny.max() == 5000);
+    REQUIRE(*tiny.select(2000) == 2001);
+
+    bubble<int, 16> few;
+    few.insert(3, 1, 2);
+    bubble<int, 8> converted = few;
+    REQUIRE(converted.pivots() == 3);
+    REQUIRE(converted.get_key(0) == 1);
+}
+
+TEST_CASE("Testing snapshot for bubble") {
+    bubble<int, 8> b;
+    for(int i = 0; i < 1000; i++) { b.insert(i); }
+    REQUIRE(b.min() == 0);
+    REQUIRE(b.max() == 999);
+    bubble<int, 8> snap = b.snapshot();
+    b.pop_min();
+    b.pop_max();
+    for(int i = 1000; i < 1100; i++) { b.insert(i); }
+    for(int i = 100; i < 200; i++) { b.remove(i); }
+    b.erase_if([](int x) { return x % 3 == 0; });
+    REQUIRE(snap.size() == 1000);
+    REQUIRE(snap.min() == 0);
+    REQUIRE(snap.max() == 999);
+    int expected = 0;
+    for(auto it = snap.cbegin(); it != snap.cend(); ++it) { REQUIRE(*it == expected++); }
+    REQUIRE(expected == 1000);
+    REQUIRE(b.size() == 666);
+    REQUIRE(b.min() == 1);
+    REQUIRE(b.max() == 1099);
+    REQUIRE(b.search(150) == false);
+
+    // the snapshot stays intact while another thread reads it
+    std::future<size_t> reader = std::async(std::launch::async, [&snap]() {
+        size_t found = 0;
+        for(int i = 0; i < 1000; i++) { found += snap.search(i); }
+        return found;
+    });
+    for(int i = 0; i < 1000; i++) { b.remove(i); }
+    REQUIRE(reader.get() == 1000);
+    REQUIRE(b.size() == 67);
+}
+
+namespace {
+    struct tracked {
+        int id;
+        static inline size_t copies = 0;
+        tracked(int id) : id(id) {}
+        tracked(const tracked& other) : id(other.id) { copies++; }
+        tracked& operator=(const tracked&) = default;
+    };
+}
+
+TEST_CASE("Testing duplicate inserts after a snapshot") {
+    bubble<tracked, 4, std::less<>, &tracked::id> b;
+    for(int i = 0; i < 1000; i++) { b.insert(tracked(i)); }
+    auto snap = b.snapshot();
+    tracked::copies = 0;
+    // a key that exists leaves the nodes it shares with the snapshot alone
+    for(int i = 0; i < 1000; i++) { REQUIRE(b.insert(tracked(i)).second == false); }
+    REQUIRE(b.find_or_insert(7, []() { return tracked(7); }).second == false);
+    REQUIRE(tracked::copies == 0);
+    REQUIRE(b.find_or_insert_unshared(7, []() { return tracked(7); }).second == false);
+    REQUIRE(tracked::copies > 0);
+    REQUIRE(snap.size() == 1000);
+    REQUIRE(b.size() == 1000);
+}
+
+TEST_CASE("Testing replace_min when the first bucket is also the last") {
+    bubble<int, 1> b;
+    b.insert(10);
+    b.insert(20);
+    REQUIRE(b.max() == 20);
+    REQUIRE(b.replace_min(15).second == true);
+    REQUIRE(b.max() == 20);
+    REQUIRE(b.min() == 15);
+    REQUIRE(b.size() == 2);
+}
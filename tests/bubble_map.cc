@@ -0,0 +1,72 @@
+#include "../tools/catch.hpp"
+#include "../src/bubble_map.h"
+#include <string>
+
+TEST_CASE("Testing operator [] for bubble_map class") {
+    bubble_map<int, std::string, 3> m;
+    m[10] = "ten";
+    m[5] = "five";
+    m[20] = "twenty";
+    m[15] = "fifteen";
+    m[1] = "one";
+    REQUIRE(m.size() == 5);
+    REQUIRE(m[15] == "fifteen");
+    REQUIRE(m[1] == "one");
+    m[15] += "!";
+    REQUIRE(*m.find(15) == "fifteen!");
+    REQUIRE(m[7].empty());
+    REQUIRE(m.size() == 6);
+}
+
+TEST_CASE("Testing find and contains for bubble_map class") {
+    bubble_map<std::string, int, 5> m;
+    for(int i = 0; i<50; i++){
+        m[std::to_string(i)] = i;
+    }
+    REQUIRE(m.contains("42") == true);
+    REQUIRE(m.contains("50") == false);
+    REQUIRE(*m.find("7") == 7);
+    REQUIRE(m.find("100") == nullptr);
+    const bubble_map<std::string, int, 5>& cm = m;
+    REQUIRE(*cm.find("49") == 49);
+}
+
+TEST_CASE("Testing try_emplace and insert_or_assign for bubble_map class") {
+    bubble_map<int, std::pair<int, int>, 3> m;
+    auto [value, inserted] = m.try_emplace(4, 1, 2);
+    REQUIRE(inserted == true);
+    REQUIRE(value->second == 2);
+    auto [same, again] = m.try_emplace(4, 5, 6);
+    REQUIRE(again == false);
+    REQUIRE(same->first == 1);
+
+    auto [assigned, fresh] = m.insert_or_assign(4, std::pair<int, int>(7, 8));
+    REQUIRE(fresh == false);
+    REQUIRE(assigned->first == 7);
+    REQUIRE(m.insert_or_assign(9, std::pair<int, int>(0, 0)).second == true);
+    REQUIRE(m.size() == 2);
+}
+
+TEST_CASE("Testing erase for bubble_map class") {
+    bubble_map<int, int, 3> m;
+    for(int i = 0; i<20; i++){
+        m[i] = i * i;
+    }
+    REQUIRE(m.erase(4) == 1);
+    REQUIRE(m.erase(4) == 0);
+    REQUIRE(m.find(4) == nullptr);
+    REQUIRE(m.size() == 19);
+    // the freed value slot is reused
+    m[100] = 1;
+    REQUIRE(m[100] == 1);
+    REQUIRE(m[5] == 25);
+    for(int i = 0; i<20; i++){
+        // the first keys are pivots, the rest live in the trees
+        REQUIRE(m.erase(i) == (i == 4 ? 0 : 1));
+        REQUIRE(m.find(i) == nullptr);
+        if(i < 19) { REQUIRE(*m.find(19) == 361); }
+    }
+    REQUIRE(m.size() == 1);
+    REQUIRE(m.empty() == false);
+    REQUIRE(m[100] == 1);
+}
@@ -0,0 +1,99 @@
+#include "../tools/catch.hpp"
+#include "../src/bubble_multiset.h"
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("Testing insert and count for bubble_multiset class") {
+    bubble_multiset<int, 3> m;
+    REQUIRE(m.insert(10) == 1);
+    REQUIRE(m.insert(10) == 2);
+    m.insert(5);
+    m.insert(20);
+    for(int i = 0; i<10; i++){
+        m.insert(15);
+        m.insert(5);
+    }
+    REQUIRE(m.count(10) == 2);
+    REQUIRE(m.count(15) == 10);
+    REQUIRE(m.count(5) == 11);
+    REQUIRE(m.count(7) == 0);
+    REQUIRE(m.size() == 24);
+    REQUIRE(m.distinct() == 4);
+}
+
+TEST_CASE("Testing erase_one and erase for bubble_multiset class") {
+    bubble_multiset<std::string, 3> m;
+    for(auto && word : {"a", "b", "c", "d", "b", "d", "d"}){
+        m.insert(word);
+    }
+    REQUIRE(m.erase_one("d") == true);
+    REQUIRE(m.count("d") == 2);
+    REQUIRE(m.erase_one("a") == true);
+    REQUIRE(m.contains("a") == false);
+    REQUIRE(m.erase_one("a") == false);
+    REQUIRE(m.erase("d") == 2);
+    REQUIRE(m.erase("d") == 0);
+    REQUIRE(m.size() == 3);
+    REQUIRE(m.distinct() == 2);
+    REQUIRE(m.count("b") == 2);
+    m.erase("b");
+    m.erase("c");
+    REQUIRE(m.empty() == true);
+}
+
+TEST_CASE("Testing key projection for bubble_multiset class") {
+    bubble_multiset<std::pair<int, std::string>, 3, std::less<>, &std::pair<int, std::string>::first> m;
+    m.insert({1, "first"});
+    m.insert({1, "ignored"});
+    m.insert({2, "second"});
+    REQUIRE(m.count(1) == 2);
+    REQUIRE(m.erase_one(1) == true);
+    REQUIRE(m.count(1) == 1);
+}
+
+TEST_CASE("Testing copies of bubble_multiset class") {
+    bubble_multiset<int, 4> s;
+    for(int i = 0; i < 100; i++) { s.insert(i % 20); }
+    bubble_multiset<int, 4> copy(s);
+    for(int i = 0; i < 20; i++) {
+        copy.insert(i);
+        copy.erase_one(i);
+        copy.erase_one(i);
+    }
+    REQUIRE(copy.size() == 80);
+    REQUIRE(s.size() == 100);
+    for(int i = 0; i < 20; i++) {
+        REQUIRE(s.count(i) == 5);
+        REQUIRE(copy.count(i) == 4);
+    }
+}
+
+namespace {
+    struct fragile {
+        int id;
+        static inline bool fail = false;
+        fragile(int id) : id(id) {}
+        fragile(const fragile& other) : id(other.id) {
+            if(fail) { throw std::runtime_error("copy failed"); }
+        }
+        fragile& operator=(const fragile&) = default;
+    };
+}
+
+TEST_CASE("Testing a throwing insert and erase of every key for bubble_multiset class") {
+    bubble_multiset<fragile, 4, std::less<>, &fragile::id> m;
+    for(int i = 0; i < 50; i++) { m.insert(fragile(i % 10)); }
+    fragile::fail = true;
+    REQUIRE_THROWS(m.insert(fragile(100)));
+    // an existing key is not copied, so it is still counted
+    REQUIRE(m.insert(fragile(3)) == 6);
+    fragile::fail = false;
+    REQUIRE(m.size() == 51);
+    REQUIRE(m.distinct() == 10);
+    for(int i = 0; i < 10; i++) {
+        REQUIRE(m.erase(i) == (i == 3 ? 6 : 5));
+        REQUIRE(m.erase(i) == 0);
+        REQUIRE(m.contains(i) == false);
+    }
+    REQUIRE(m.empty() == true);
+}
@@ -0,0 +1,81 @@
+#include "../tools/catch.hpp"
+#include "../src/bubble_mvcc.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::atomic<int> live{0};
+
+    struct counted {
+        int v;
+        counted(int v) : v(v) { live++; }
+        counted(const counted& other) : v(other.v) { live++; }
+        counted& operator=(const counted&) = default;
+        ~counted() { live--; }
+    };
+}
+
+TEST_CASE("Testing pinned versions for bubble_mvcc class") {
+    bubble_mvcc<int, 8> b;
+    for(int i = 0; i < 100; i++) { REQUIRE(b.insert(i) == true); }
+    REQUIRE(b.insert(5) == false);
+    REQUIRE(b.epoch() == 100);
+    auto before = b.pin();
+    REQUIRE(before.epoch() == 100);
+    for(int i = 0; i < 50; i++) { b.remove(i); }
+    b.write([](auto& current) {
+        for(int i = 100; i < 120; i++) { current.insert(i); }
+    });
+    REQUIRE(b.epoch() == 151);
+    REQUIRE(b.size() == 70);
+    REQUIRE(b.contains(10) == false);
+    REQUIRE(before->size() == 100);
+    REQUIRE(before->search(10) == true);
+    REQUIRE(before->search(110) == false);
+    std::vector<int> keys(before->cbegin(), before->cend());
+    REQUIRE(keys.size() == 100);
+    REQUIRE(keys.front() == 0);
+    REQUIRE(keys.back() == 99);
+    auto after = b.pin();
+    REQUIRE(after->size() == 70);
+    REQUIRE((*after).min() == 50);
+    REQUIRE(after->max() == 119);
+}
+
+TEST_CASE("Testing that bubble_mvcc frees a version with its last pin") {
+    {
+        bubble_mvcc<counted, 4, std::less<>, &counted::v> b;
+        for(int i = 0; i < 1000; i++) { b.insert(counted(i)); }
+        REQUIRE(live == 1000);
+        {
+            auto pinned = b.pin();
+            for(int i = 0; i < 1000; i++) { b.remove(i); }
+            REQUIRE(b.size() == 0);
+            REQUIRE(live == 1000);
+            REQUIRE(pinned->size() == 1000);
+        }
+        REQUIRE(live == 0);
+    }
+    REQUIRE(live == 0);
+}
+
+TEST_CASE("Testing bubble_mvcc scans concurrent with a writer") {
+    bubble_mvcc<int, 16> b;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for(int i = 0; i < 20000; i++) { b.insert(i); }
+        done = true;
+    });
+    bool consistent = true;
+    while(!done) {
+        auto v = b.pin();
+        // the writer inserts in order, so every version holds exactly 0 .. epoch - 1
+        int expected = 0;
+        for(auto it = v->cbegin(); it != v->cend(); ++it) { consistent = consistent && *it == expected++; }
+        consistent = consistent && static_cast<uint64_t>(expected) == v.epoch();
+    }
+    writer.join();
+    REQUIRE(consistent == true);
+    REQUIRE(b.pin()->size() == 20000);
+}
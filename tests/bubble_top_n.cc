@@ -0,0 +1,54 @@
+#include "../tools/catch.hpp"
+#include "../src/bubble_top_n.h"
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <set>
+#include <vector>
+
+TEST_CASE("Testing insert and eviction for bubble_top_n class") {
+    bubble_top_n<int, 4> top(5);
+    REQUIRE(top.empty() == true);
+    REQUIRE(top.capacity() == 5);
+    for(int i : {7, 3, 9, 1, 5}){
+        REQUIRE(top.insert(i) == true);
+    }
+    REQUIRE(top.size() == 5);
+    REQUIRE(top.min() == 1);
+    REQUIRE(top.insert(0) == false);
+    REQUIRE(top.insert(1) == false);
+    REQUIRE(top.insert(9) == false);
+    REQUIRE(top.insert(4) == true);
+    REQUIRE(top.contains(1) == false);
+    REQUIRE(top.min() == 3);
+    REQUIRE(top.insert(20) == true);
+    REQUIRE(top.size() == 5);
+    REQUIRE(top.min() == 4);
+    REQUIRE(top.max() == 20);
+    std::vector<int> kept(top.cbegin(), top.cend());
+    REQUIRE(kept == std::vector<int>{4, 5, 7, 9, 20});
+}
+
+TEST_CASE("Testing bubble_top_n against a sorted set") {
+    std::mt19937 rng(11);
+    bubble_top_n<int, 8> top(100);
+    bubble_top_n<int, 8, std::greater<>> bottom(100);
+    std::set<int> all;
+    for(int i = 0; i < 20000; i++){
+        int key = static_cast<int>(rng() % 50000);
+        top.insert(key);
+        bottom.insert(key);
+        all.insert(key);
+        if(i % 997 == 0){
+            REQUIRE(top.size() == std::min<size_t>(all.size(), 100));
+            REQUIRE(top.min() == *std::next(all.rbegin(), top.size() - 1));
+            REQUIRE(bottom.min() == *std::next(all.begin(), bottom.size() - 1));
+        }
+    }
+    std::vector<int> expected(std::next(all.rbegin(), 100).base(), all.end());
+    REQUIRE(std::vector<int>(top.cbegin(), top.cend()) == expected);
+    std::vector<int> smallest(all.begin(), std::next(all.begin(), 100));
+    std::vector<int> kept(bottom.cbegin(), bottom.cend());
+    std::reverse(kept.begin(), kept.end());
+    REQUIRE(kept == smallest);
+}
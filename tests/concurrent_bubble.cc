@@ -0,0 +1,162 @@
+#include "../tools/catch.hpp"
+#include "../src/concurrent_bubble.h"
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Testing concurrent_bubble against a sorted set") {
+    concurrent_bubble<int, 8> b;
+    std::set<int> keys;
+    std::mt19937 rng(13);
+    for(int i = 0; i < 20000; i++) {
+        int key = static_cast<int>(rng() % 2000);
+        if(rng() % 3) { REQUIRE(b.insert(key) == keys.insert(key).second); }
+        else { REQUIRE(b.remove(key) == keys.erase(key)); }
+        REQUIRE(b.search(key) == keys.contains(key));
+    }
+    REQUIRE(b.size() == keys.size());
+    std::vector<int> visited;
+    b.for_each([&](int key) { visited.push_back(key); });
+    REQUIRE(visited == std::vector<int>(keys.begin(), keys.end()));
+}
+
+TEST_CASE("Testing concurrent_bubble seeded from a bubble") {
+    bubble<int, 16> seed;
+    for(int i = 0; i < 1000; i++) { seed.insert(i * 2); }
+    concurrent_bubble<int, 16> b(seed);
+    REQUIRE(b.size() == 1000);
+    REQUIRE(b.insert(3) == true);
+    REQUIRE(b.remove(4) == 1);
+    REQUIRE(seed.search(3) == false);
+    REQUIRE(seed.search(4) == true);
+    REQUIRE(b.search(3) == true);
+    REQUIRE(b.search(4) == false);
+    REQUIRE(b.search(1998) == true);
+}
+
+TEST_CASE("Testing concurrent_bubble with many threads") {
+    concurrent_bubble<int, 64> b;
+    const int threads = 8, per_thread = 5000;
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&b, t]() {
+            // every thread owns the keys k with k % threads == t
+            for(int i = 0; i < per_thread; i++) { b.insert(i * threads + t); }
+            for(int i = 0; i < per_thread; i += 2) { b.remove(i * threads + t); }
+            for(int i = 0; i < per_thread; i++) { b.search((i * 7919) % (per_thread * threads)); }
+        });
+    }
+    for(auto && worker : workers) { worker.join(); }
+    REQUIRE(b.size() == threads * per_thread / 2);
+    size_t visited = 0;
+    int last = -1;
+    bool sorted = true;
+    b.for_each([&](int key) {
+        sorted = sorted && key > last && (key / threads) % 2 == 1;
+        last = key;
+        visited++;
+    });
+    REQUIRE(sorted == true);
+    REQUIRE(visited == b.size());
+}
+
+TEST_CASE("Testing rebalance for concurrent_bubble") {
+    concurrent_bubble<int, 16> b;
+    // increasing keys put everything after the first 16 into the last bucket
+    for(int i = 0; i < 5000; i++) { b.insert(i); }
+    for(int i = 0; i < 16; i += 2) { b.remove(i); }
+    std::atomic<bool> done{false};
+    std::atomic<int> missing{0};
+    std::thread reader([&]() {
+        while(!done) {
+            for(int i = 16; i < 5000; i += 97) { missing += !b.search(i); }
+        }
+    });
+    b.rebalance();
+    b.insert(5000);
+    b.remove(4000);
+    b.rebalance();
+    done = true;
+    reader.join();
+    REQUIRE(missing == 0);
+    REQUIRE(b.size() == 4992);
+    std::vector<int> visited;
+    b.for_each([&](int key) { visited.push_back(key); });
+    REQUIRE(visited.size() == 4992);
+    REQUIRE(std::is_sorted(visited.begin(), visited.end()) == true);
+    REQUIRE(visited.front() == 1);
+    REQUIRE(visited.back() == 5000);
+    REQUIRE(b.search(4000) == false);
+    REQUIRE(b.search(2) == false);
+    REQUIRE(b.search(3) == true);
+
+    concurrent_bubble<int, 16> few;
+    for(int i = 0; i < 5; i++) { few.insert(i); }
+    few.rebalance();
+    REQUIRE(few.insert(10) == true);
+    REQUIRE(few.insert(3) == false);
+    REQUIRE(few.remove(3) == 1);
+    REQUIRE(few.size() == 5);
+}
+
+TEST_CASE("Testing concurrent_bubble with lockfree_skiplist buckets") {
+    bubble<int, 16> seed;
+    for(int i = 0; i < 1000; i++) { seed.insert(i * 2); }
+    concurrent_bubble<int, 16, std::less<>, std::identity{}, lockfree_skiplist> b(seed);
+    REQUIRE(b.size() == 1000);
+    const int threads = 8, per_thread = 2000;
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&b, t]() {
+            // odd keys above 2000 are owned by one thread each, the seeded keys are removed by all
+            for(int i = 0; i < per_thread; i++) { b.insert(2001 + 2 * (i * threads + t)); }
+            for(int i = 0; i < 1000; i += 2) { b.remove(i * 2); }
+            for(int i = 0; i < per_thread; i++) { b.search(i); }
+        });
+    }
+    for(auto && worker : workers) { worker.join(); }
+    REQUIRE(b.size() == 500 + threads * per_thread);
+    REQUIRE(b.search(0) == false);
+    REQUIRE(b.search(2) == true);
+    REQUIRE(b.search(2001) == true);
+    b.rebalance();
+    std::vector<int> visited;
+    b.for_each([&](int key) { visited.push_back(key); });
+    REQUIRE(visited.size() == b.size());
+    REQUIRE(std::is_sorted(visited.begin(), visited.end()) == true);
+    REQUIRE(b.remove(2) == 1);
+    REQUIRE(b.search(2) == false);
+}
+
+TEST_CASE("Testing concurrent_bubble with combining_avl_bucket buckets") {
+    concurrent_bubble<int, 4, std::less<>, std::identity{}, combining_avl_bucket> b;
+    for(int i = 0; i < 4; i++) { b.insert(i * 1000000); }
+    // every write goes to the bucket of pivot 1, so the writers keep combining
+    const int threads = 12, per_thread = 3000;
+    std::atomic<int> wrong{0};
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&b, &wrong, t]() {
+            for(int i = 0; i < per_thread; i++) {
+                int key = 1000001 + i * threads + t;
+                wrong += b.insert(key) != true;
+                wrong += b.insert(key) != false;
+                if(i % 3 == 0) { wrong += b.remove(key) != 1; }
+                wrong += b.search(key) != (i % 3 != 0);
+            }
+        });
+    }
+    for(auto && worker : workers) { worker.join(); }
+    REQUIRE(wrong == 0);
+    REQUIRE(b.size() == 4 + threads * (per_thread - per_thread / 3));
+    std::vector<int> visited;
+    b.for_each([&](int key) { visited.push_back(key); });
+    REQUIRE(visited.size() == b.size());
+    REQUIRE(std::is_sorted(visited.begin(), visited.end()) == true);
+    REQUIRE(b.remove(1000001) == 0);
+    REQUIRE(b.remove(1000014) == 1);
+    REQUIRE(b.search(1000014) == false);
+}
@@ -0,0 +1,38 @@
+#include "../tools/catch.hpp"
+#include "../src/epoch.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+    std::atomic<int> freed{0};
+
+    struct tracked {
+        ~tracked() { freed++; }
+    };
+}
+
+TEST_CASE("Testing that retired objects outlive the guards that could reach them") {
+    auto& domain = bubble_detail::epoch_domain::instance();
+    std::atomic<int> stage{0};
+    std::thread reader([&]() {
+        bubble_detail::epoch_domain::guard reading;
+        stage = 1;
+        while(stage != 2) { std::this_thread::yield(); }
+    });
+    while(stage != 1) { std::this_thread::yield(); }
+    for(int i = 0; i < 100; i++) { domain.retire(new tracked); }
+    domain.collect();
+    REQUIRE(freed == 0);
+    stage = 2;
+    reader.join();
+    domain.collect();
+    REQUIRE(freed == 100);
+    {
+        // a guard that starts after the retirement does not hold it back
+        domain.retire(new tracked);
+        bubble_detail::epoch_domain::guard reading;
+        bubble_detail::epoch_domain::guard nested;
+        domain.collect();
+        REQUIRE(freed == 101);
+    }
+}
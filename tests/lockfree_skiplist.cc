@@ -0,0 +1,72 @@
+#include "../tools/catch.hpp"
+#include "../src/lockfree_skiplist.h"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Testing lockfree_skiplist against a sorted set") {
+    lockfree_skiplist<int> s;
+    std::set<int> keys;
+    std::mt19937 rng(21);
+    for(int i = 0; i < 20000; i++) {
+        int key = static_cast<int>(rng() % 2000);
+        if(rng() % 3) { REQUIRE(s.insert(key) == keys.insert(key).second); }
+        else { REQUIRE(s.remove(key) == keys.erase(key)); }
+        REQUIRE(s.search(key) == keys.contains(key));
+    }
+    REQUIRE(s.size() == keys.size());
+    std::vector<int> visited;
+    s.for_each([&](int key) { visited.push_back(key); });
+    REQUIRE(visited == std::vector<int>(keys.begin(), keys.end()));
+}
+
+TEST_CASE("Testing fill and projections for lockfree_skiplist") {
+    lockfree_skiplist<std::pair<int, std::string>, std::greater<>, &std::pair<int, std::string>::first> s;
+    std::vector<std::pair<int, std::string>> sorted;
+    for(int i = 100; i > 0; i--) { sorted.push_back({i, std::to_string(i)}); }
+    s.fill(sorted.begin(), sorted.end());
+    REQUIRE(s.size() == 100);
+    REQUIRE(s.search(50) == true);
+    REQUIRE(s.search(0) == false);
+    REQUIRE(s.insert({0, "0"}) == true);
+    REQUIRE(s.insert({50, "fifty"}) == false);
+    REQUIRE(s.remove(100) == 1);
+    std::vector<int> visited;
+    s.for_each([&](const auto& p) { visited.push_back(p.first); });
+    REQUIRE(visited.size() == 100);
+    REQUIRE(visited.front() == 99);
+    REQUIRE(visited.back() == 0);
+}
+
+TEST_CASE("Testing lockfree_skiplist with threads that fight over the same keys") {
+    lockfree_skiplist<int> s;
+    const int threads = 8, range = 512, rounds = 20000;
+    std::vector<std::thread> workers;
+    std::vector<long> balance(threads, 0);
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            for(int i = 0; i < rounds; i++) {
+                int key = static_cast<int>(rng() % range);
+                if(rng() % 2) { balance[t] += s.insert(key); }
+                else { balance[t] -= static_cast<long>(s.remove(key)); }
+                s.search(static_cast<int>(rng() % range));
+            }
+        });
+    }
+    for(auto && worker : workers) { worker.join(); }
+    long expected = 0;
+    for(long b : balance) { expected += b; }
+    std::vector<int> visited;
+    s.for_each([&](int key) { visited.push_back(key); });
+    REQUIRE(static_cast<long>(visited.size()) == expected);
+    REQUIRE(s.size() == visited.size());
+    REQUIRE(std::is_sorted(visited.begin(), visited.end()) == true);
+    REQUIRE(std::adjacent_find(visited.begin(), visited.end()) == visited.end());
+    for(int key = 0; key < range; key++) {
+        REQUIRE(s.search(key) == std::binary_search(visited.begin(), visited.end(), key));
+    }
+}
@@ -0,0 +1,68 @@
+#include "../tools/catch.hpp"
+#include "../src/sharded_bubble.h"
+#include <random>
+#include <set>
+#include <vector>
+
+TEST_CASE("Testing sharded_bubble against a sorted set") {
+    sharded_bubble<int, 8> b(std::vector<int>{500, 1000, 1500});
+    REQUIRE(b.shards() == 4);
+    std::set<int> keys;
+    std::mt19937 rng(17);
+    for(int round = 0; round < 200; round++) {
+        std::vector<int> batch(50);
+        for(auto && key : batch) { key = static_cast<int>(rng() % 2000) - 100; }
+        std::set<int> unique(batch.begin(), batch.end());
+        std::vector<bool> expected;
+        for(int key : batch) { expected.push_back(keys.contains(key)); }
+        // the search is queued before the write, so it answers for the keys before the write
+        auto found = b.search(batch);
+        std::future<size_t> changed;
+        size_t count = 0;
+        if(round % 3) {
+            changed = b.insert(batch);
+            for(int key : unique) { count += keys.insert(key).second; }
+        }
+        else {
+            changed = b.remove(batch);
+            for(int key : unique) { count += keys.erase(key); }
+        }
+        REQUIRE(found.get() == expected);
+        REQUIRE(changed.get() == count);
+        REQUIRE(b.size() == keys.size());
+    }
+    std::vector<int> visited;
+    b.for_each([&](int key) { visited.push_back(key); });
+    REQUIRE(visited == std::vector<int>(keys.begin(), keys.end()));
+    REQUIRE(b.search({}).get().empty() == true);
+    REQUIRE(b.insert({}).get() == 0);
+}
+
+TEST_CASE("Testing sharded_bubble built from a bubble") {
+    bubble<int, 16> seed;
+    for(int i = 0; i < 1000; i++) { seed.insert(i * 3); }
+    sharded_bubble<int, 16> b(seed, 4);
+    REQUIRE(b.shards() == 4);
+    REQUIRE(b.size() == 1000);
+    REQUIRE(b.insert({1, 2, 4, 2997}).get() == 3);
+    REQUIRE(b.search({0, 1, 5, 2997, 3000}).get() == std::vector<bool>{true, true, false, true, false});
+    auto shards = b.snapshot().get();
+    REQUIRE(shards.size() == 4);
+    for(auto && shard : shards) { REQUIRE(shard.size() > 200); }
+    REQUIRE(b.remove({0, 1, 5}).get() == 2);
+    REQUIRE(shards[0].search(0) == true);
+    size_t visited = 0;
+    int last = -1;
+    bool sorted = true;
+    b.for_each([&](int key) {
+        sorted = sorted && key > last;
+        last = key;
+        visited++;
+    });
+    REQUIRE(sorted == true);
+    REQUIRE(visited == 1001);
+
+    sharded_bubble<int, 16> tiny(bubble<int, 16>(), 8);
+    REQUIRE(tiny.shards() == 1);
+    REQUIRE(tiny.empty() == true);
+}
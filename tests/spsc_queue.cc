@@ -0,0 +1,38 @@
+#include "../tools/catch.hpp"
+#include "../src/spsc_queue.h"
+#include <memory>
+#include <thread>
+
+TEST_CASE("Testing spsc_queue in a single thread") {
+    bubble_detail::spsc_queue<std::unique_ptr<int>> q(3);
+    REQUIRE(q.try_pop().has_value() == false);
+    for(int i = 0; i < 4; i++) {
+        auto item = std::make_unique<int>(i);
+        REQUIRE(q.try_push(item) == true);
+    }
+    auto extra = std::make_unique<int>(4);
+    REQUIRE(q.try_push(extra) == false);
+    REQUIRE(*extra == 4);
+    REQUIRE(*q.pop() == 0);
+    REQUIRE(q.try_push(extra) == true);
+    for(int i = 1; i <= 4; i++) { REQUIRE(*q.pop() == i); }
+    REQUIRE(q.try_pop().has_value() == false);
+}
+
+TEST_CASE("Testing spsc_queue between two threads") {
+    bubble_detail::spsc_queue<long> q(16);
+    const long n = 200000;
+    long sum = 0;
+    bool ordered = true;
+    std::thread consumer([&]() {
+        for(long i = 0; i < n; i++) {
+            long v = q.pop();
+            ordered = ordered && v == i;
+            sum += v;
+        }
+    });
+    for(long i = 0; i < n; i++) { q.push(i); }
+    consumer.join();
+    REQUIRE(ordered == true);
+    REQUIRE(sum == n * (n - 1) / 2);
+}